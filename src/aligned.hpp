@@ -0,0 +1,82 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+namespace snake {
+	/// Deleter for objects allocated with makeAligned() and makeAlignedArray().
+	template<typename T>
+	struct AlignedDelete {
+		std::size_t count;
+
+		AlignedDelete(std::size_t count = 1) : count(count) {}
+
+		void operator()(T * objects) const {
+			for (std::size_t i = count; i > 0; --i) objects[i - 1].~T();
+			std::free(objects);
+		}
+	};
+
+	/// An owning pointer to an object or array that honours the alignment of its type.
+	template<typename T>
+	using AlignedPtr = std::unique_ptr<T, AlignedDelete<T>>;
+
+	template<typename T>
+	using AlignedArray = std::unique_ptr<T[], AlignedDelete<T>>;
+
+	/// Allocate and default construct count objects, aligned to the alignment of their type.
+	/**
+	 * C++11 new only guarantees the alignment of std::max_align_t,
+	 * so types that are aligned to a cache line have to be allocated with this instead.
+	 * Throws std::bad_alloc if there is no memory, or whatever the constructor throws.
+	 */
+	template<typename T>
+	T * allocateAligned(std::size_t count) {
+		void * memory         = nullptr;
+		std::size_t alignment = alignof(T) < sizeof(void *) ? sizeof(void *) : alignof(T);
+		if (::posix_memalign(&memory, alignment, count * sizeof(T)) != 0) throw std::bad_alloc();
+
+		T * objects = static_cast<T *>(memory);
+		std::size_t constructed = 0;
+		try {
+			for (; constructed < count; ++constructed) new (objects + constructed) T();
+		} catch (...) {
+			AlignedDelete<T> destroy(constructed);
+			destroy(objects);
+			throw;
+		}
+		return objects;
+	}
+
+	/// Allocate and default construct an object, aligned to the alignment of its type.
+	template<typename T>
+	AlignedPtr<T> makeAligned() {
+		return AlignedPtr<T>(allocateAligned<T>(1));
+	}
+
+	/// Allocate and default construct an array, aligned to the alignment of its type.
+	template<typename T>
+	AlignedArray<T> makeAlignedArray(std::size_t count) {
+		return AlignedArray<T>(allocateAligned<T>(count), AlignedDelete<T>(count));
+	}
+}
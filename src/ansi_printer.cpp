@@ -0,0 +1,132 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ansi_printer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace snake {
+	namespace {
+		/// Rewriting an unchanged cell takes three bytes, moving the cursor takes up to ten.
+		constexpr int max_gap = 3;
+
+		void appendNumber(std::string & buffer, int value) {
+			char digits[12];
+			int length = 0;
+			do {
+				digits[length++] = '0' + value % 10;
+				value /= 10;
+			} while (value > 0);
+			while (length > 0) buffer.push_back(digits[--length]);
+		}
+
+		/// Move the cursor to a zero based row and column.
+		void appendMove(std::string & buffer, int y, int x) {
+			buffer += "\x1b[";
+			appendNumber(buffer, y + 1);
+			buffer.push_back(';');
+			appendNumber(buffer, x + 1);
+			buffer.push_back('H');
+		}
+
+		/// Select the foreground and background color of a color pair index.
+		void appendColor(std::string & buffer, std::uint8_t pair) {
+			int fg = (pair - 1) / 8;
+			int bg = (pair - 1) % 8;
+			buffer += "\x1b[3";
+			buffer.push_back('0' + fg);
+			buffer += ";4";
+			buffer.push_back('0' + bg);
+			buffer.push_back('m');
+		}
+
+		/// The upper half block in UTF-8.
+		char const upper_half[] = "\xe2\x96\x80";
+	}
+
+	AnsiPrinter::AnsiPrinter(int fd) : fd_(fd) {}
+
+	void AnsiPrinter::print(int start_y, int start_x, Field const & field) {
+		int const width = field.size().x;
+		int const rows  = (field.size().y + 1) / 2;
+
+		if (field.size() != size_) {
+			size_ = field.size();
+			pairs_.assign(width, 0);
+			previous_.assign(std::size_t(width) * rows, 0);
+			full_redraw_ = true;
+		}
+
+		buffer_.clear();
+		buffer_ += "\x1b" "7";
+
+		std::uint8_t color = 0;
+		for (int row = 0; row < rows; ++row) {
+			colorPairRow(field, row * 2, pairs_.data());
+			std::uint8_t * previous = &previous_[std::size_t(row) * width];
+
+			// The cursor column, or -1 if it is not on this row.
+			int cursor = -1;
+			auto emit = [&] (int x) {
+				if (pairs_[x] != color) {
+					color = pairs_[x];
+					appendColor(buffer_, color);
+				}
+				buffer_ += upper_half;
+				previous[x] = pairs_[x];
+			};
+
+			for (int x = 0; x < width; ++x) {
+				if (!full_redraw_ && pairs_[x] == previous[x]) continue;
+
+				if (cursor >= 0 && x >= cursor && x - cursor <= max_gap) {
+					// Rewrite the unchanged cells in between rather than moving the cursor.
+					for (; cursor < x; ++cursor) emit(cursor);
+				} else if (cursor != x) {
+					appendMove(buffer_, start_y + row, start_x + x);
+				}
+				emit(x);
+				cursor = x + 1;
+			}
+		}
+
+		full_redraw_ = false;
+
+		// Nothing changed, so there is no need for a write at all.
+		if (buffer_.size() == 2) {
+			buffer_.clear();
+			return;
+		}
+		buffer_ += "\x1b[0m\x1b" "8";
+
+		// A single write, unless the terminal only takes part of the frame.
+		std::size_t written = 0;
+		while (written < buffer_.size()) {
+			ssize_t result = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+			if (result < 0) {
+				if (errno == EINTR) continue;
+				throw std::runtime_error(std::string("Failed to write frame: ") + std::strerror(errno));
+			}
+			written += result;
+		}
+	}
+}
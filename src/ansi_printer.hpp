@@ -0,0 +1,64 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "field.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace snake {
+	/// Prints fields to a terminal with ANSI escape sequences, bypassing curses.
+	/**
+	 * Like FieldPrinter, each terminal cell shows two vertically stacked pixels
+	 * and only the cells that changed since the previous frame are emitted.
+	 * A frame is built in one buffer that is reused between frames and written with a single write() call:
+	 *  - the cursor is only moved when it is not already at the next changed cell,
+	 *    and short gaps of unchanged cells are rewritten instead of jumped over,
+	 *  - a color is only selected when it differs from the previous cell.
+	 *
+	 * The frame is wrapped in a save and restore of the cursor and attributes,
+	 * so it can be mixed with curses output elsewhere on the screen.
+	 */
+	class AnsiPrinter {
+		int fd_;
+		Vector2 size_{0, 0};
+		std::vector<std::uint8_t> pairs_;
+		std::vector<std::uint8_t> previous_;
+		std::string buffer_;
+		bool full_redraw_ = true;
+
+	public:
+		/// Create a printer that writes to a file descriptor.
+		explicit AnsiPrinter(int fd);
+
+		/// Make the next call to print() redraw every cell.
+		void invalidate() { full_redraw_ = true; }
+
+		/// Print a field with the top left corner at a zero based terminal row and column.
+		/**
+		 * Throws std::runtime_error if writing to the file descriptor fails.
+		 */
+		void print(int start_y, int start_x, Field const & field);
+
+		/// Get the number of bytes the last call to print() wrote.
+		std::size_t lastFrameSize() const { return buffer_.size(); }
+	};
+}
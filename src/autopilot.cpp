@@ -0,0 +1,181 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "autopilot.hpp"
+
+#include <cstdlib>
+
+namespace snake {
+	namespace {
+		Direction const directions[4] = {Direction::up, Direction::down, Direction::left, Direction::right};
+
+		int manhattan(Vector2 const & a, Vector2 const & b) {
+			return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+		}
+	}
+
+	Autopilot::Autopilot(Vector2 const & board_size) {
+		resize(board_size);
+	}
+
+	void Autopilot::resize(Vector2 const & size) {
+		if (size == size_) return;
+		size_ = size;
+		std::size_t cells = std::size_t(size.x) * size.y;
+		visited_.assign(cells, 0);
+		queue_.assign(cells, 0);
+		first_step_.assign(cells, 0);
+		distance_.assign(cells, 0);
+		body_stamp_.assign(cells, 0);
+		vacated_in_.assign(cells, 0);
+		generation_      = 0;
+		body_generation_ = 0;
+	}
+
+	void Autopilot::beginSearch() {
+		// Clear the stamps only when the generation wraps around.
+		if (++generation_ == 0) {
+			visited_.assign(visited_.size(), 0);
+			generation_ = 1;
+		}
+	}
+
+	void Autopilot::mapBody(Snake const & snake) {
+		if (++body_generation_ == 0) {
+			body_stamp_.assign(body_stamp_.size(), 0);
+			body_generation_ = 1;
+		}
+
+		// Walk from the head to the tail. The tail is vacated in one tick, the head in length ticks.
+		Vector2 point   = snake.head;
+		int vacated_in  = snake.length;
+		for (std::size_t i = 0; i < snake.segments.size(); ++i) {
+			Segment const & segment = snake.segments[i];
+			Vector2 step = directionVector(segment.direction);
+			for (int j = 0; j < segment.length; ++j) {
+				int cell = point.y * size_.x + point.x;
+				body_stamp_[cell] = body_generation_;
+				vacated_in_[cell] = vacated_in--;
+				point -= step;
+			}
+		}
+	}
+
+	bool Autopilot::passable(Game const & game, Vector2 const & point, int ticks) const {
+		if (!pointInsideArea(point, size_)) return false;
+		if (!game.snake.occupancy.occupied(point)) return true;
+		int cell = point.y * size_.x + point.x;
+		return body_stamp_[cell] == body_generation_ && vacated_in_[cell] <= ticks;
+	}
+
+	bool Autopilot::reached(Vector2 const & point) const {
+		if (!pointInsideArea(point, size_)) return false;
+		return visited_[point.y * size_.x + point.x] == generation_;
+	}
+
+	bool Autopilot::reachesTail(Game const & game, Vector2 const & next) {
+		// When the snake eats, the tail stays put for a tick and every body cell is vacated a tick later.
+		// Starting the search a tick earlier accounts for that.
+		search(game, next, next == game.fruit ? 0 : 1, game.snake.tail);
+		return reached(game.snake.tail);
+	}
+
+	int Autopilot::search(Game const & game, Vector2 const & start, int start_ticks, Vector2 const & target) {
+		beginSearch();
+		int target_cell = pointInsideArea(target, size_) ? target.y * size_.x + target.x : -1;
+		int start_cell  = start.y * size_.x + start.x;
+
+		std::size_t read  = 0;
+		std::size_t write = 0;
+		visited_[start_cell]  = generation_;
+		distance_[start_cell] = 0;
+		queue_[write++]       = start_cell;
+
+		while (read < write) {
+			int cell = queue_[read++];
+			if (cell == target_cell) break;
+			Vector2 point = {cell % size_.x, cell / size_.x};
+			int ticks     = start_ticks + distance_[cell] + 1;
+
+			for (int d = 0; d < 4; ++d) {
+				Vector2 next = point + directionVector(directions[d]);
+				if (!passable(game, next, ticks)) continue;
+				int next_cell = next.y * size_.x + next.x;
+				if (visited_[next_cell] == generation_) continue;
+
+				visited_[next_cell]    = generation_;
+				distance_[next_cell]   = distance_[cell] + 1;
+				first_step_[next_cell] = cell == start_cell ? d : first_step_[cell];
+				queue_[write++]        = next_cell;
+			}
+		}
+
+		return write;
+	}
+
+	Action Autopilot::plan(Game const & game) {
+		resize(game.board_size);
+		if (!game.alive) return Action::none;
+
+		Snake const & snake  = game.snake;
+		Direction current    = snake.segments.front().direction;
+		Vector2 const & head = snake.head;
+		mapBody(snake);
+
+		// Take the shortest path to the fruit, if the tail can still be reached after the first step.
+		// Eating the last free cell wins, so that step needs no way back.
+		search(game, head, 0, game.fruit);
+		if (reached(game.fruit)) {
+			Direction step = directions[first_step_[game.fruit.y * size_.x + game.fruit.x]];
+			Vector2 next   = head + directionVector(step);
+			if (next == game.fruit && snake.occupancy.freeCount() == 1) return directionAction(step);
+			if (reachesTail(game, next)) return directionAction(step);
+		}
+
+		// Otherwise stall by following the body. Of the neighbours that can still reach the tail,
+		// take the one closest to the fruit, so the snake does not circle around forever.
+		int best_distance = -1;
+		Direction best    = current;
+		for (Direction direction : directions) {
+			if (direction == -current) continue;
+			Vector2 next = head + directionVector(direction);
+			if (!passable(game, next, 1)) continue;
+			if (!reachesTail(game, next)) continue;
+			int distance = manhattan(next, game.fruit);
+			if (best_distance < 0 || distance < best_distance) {
+				best_distance = distance;
+				best          = direction;
+			}
+		}
+		if (best_distance >= 0) return directionAction(best);
+
+		// No way back to the tail, so move to the largest free area.
+		int best_area = -1;
+		for (Direction direction : directions) {
+			if (direction == -current) continue;
+			Vector2 next = head + directionVector(direction);
+			if (!passable(game, next, 1)) continue;
+			int area = search(game, next, 1, {-1, -1});
+			if (area > best_area) {
+				best_area = area;
+				best      = direction;
+			}
+		}
+		return directionAction(best);
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace snake {
+	/// Picks the next direction of a snake by breadth-first search over the occupancy grid.
+	/**
+	 * Each call to plan():
+	 *  - searches the shortest path from the head to the fruit,
+	 *  - takes its first step if the tail is still reachable after that step, taking into account that the tail stays put when the snake eats,
+	 *  - otherwise moves to the neighbour closest to the fruit that can still reach the tail,
+	 *  - and as a last resort moves to the neighbour with the most reachable free cells.
+	 *
+	 * The searches know when each body cell is vacated by the tail,
+	 * so a path may run through a part of the body that will have moved away by the time the head gets there.
+	 * All search buffers are allocated for the board size up front and reused,
+	 * so planning does not allocate unless the board size changes.
+	 */
+	class Autopilot {
+		Vector2 size_ = {0, 0};
+
+		/// Cells are visited in the current search if their stamp equals the generation.
+		std::vector<std::uint32_t> visited_;
+		std::uint32_t generation_ = 0;
+
+		/// Search queue holding cell indices.
+		std::vector<int> queue_;
+
+		/// The first step taken from the search origin to reach each cell.
+		std::vector<std::uint8_t> first_step_;
+
+		/// The distance of each cell to the search origin.
+		std::vector<int> distance_;
+
+		/// The number of ticks until each body cell is vacated, valid for cells stamped with the generation.
+		std::vector<std::uint32_t> body_stamp_;
+		std::vector<int> vacated_in_;
+		std::uint32_t body_generation_ = 0;
+
+		void resize(Vector2 const & size);
+		void beginSearch();
+		void mapBody(Snake const & snake);
+
+		/// Check if the head could be on a point a given number of ticks from now.
+		bool passable(Game const & game, Vector2 const & point, int ticks) const;
+
+		/// Search from a point reached after a number of ticks, recording first steps and distances.
+		/**
+		 * Stops as soon as the target is reached, if it is inside the board.
+		 * Returns the number of reached cells.
+		 */
+		int search(Game const & game, Vector2 const & start, int start_ticks, Vector2 const & target);
+
+		bool reached(Vector2 const & point) const;
+
+		/// Check if the tail can still be reached after moving the head to a neighbouring point, growing if it holds the fruit.
+		bool reachesTail(Game const & game, Vector2 const & next);
+
+	public:
+		explicit Autopilot(Vector2 const & board_size = {0, 0});
+
+		/// Pick the action for the next tick of a game.
+		Action plan(Game const & game);
+	};
+}
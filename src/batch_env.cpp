@@ -0,0 +1,206 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch_env.hpp"
+
+#include <cstring>
+
+namespace snake {
+	namespace {
+		/// The direction an action steers in, indexed by the numeric value of Action, or 4 to keep going.
+		std::uint8_t const action_direction[6] = {4, 0, 1, 2, 3, 4};
+
+		/// The number of random cells to try before scanning the board for a free cell.
+		int const fruit_attempts = 16;
+	}
+
+	BatchEnv::BatchEnv(int count, Vector2 const & board_size, std::uint64_t seed, bool auto_reset) :
+		count_(count),
+		board_size_(board_size),
+		auto_reset_(auto_reset),
+		cells_per_game_(board_size.x * board_size.y),
+		head_x_(count), head_y_(count),
+		tail_x_(count), tail_y_(count),
+		fruit_x_(count), fruit_y_(count),
+		score_(count), length_(count),
+		direction_(count), alive_(count),
+		generators_(count),
+		cells_(std::size_t(count) * cells_per_game_),
+		next_x_(count), next_y_(count),
+		next_direction_(count), valid_(count) {
+		for (int i = 0; i < count_; ++i) generators_[i].seed(mixSeed(seed, i));
+		reset();
+	}
+
+	void BatchEnv::reset() {
+		for (int i = 0; i < count_; ++i) reset(i);
+	}
+
+	void BatchEnv::reset(int game) {
+		std::uint8_t * cells = board(game);
+		std::memset(cells, 0, cells_per_game_);
+
+		// Same starting position as Game: three cells long, moving up from the center.
+		std::uint8_t up = 1 + std::uint8_t(Direction::up);
+		int x = board_size_.x / 2;
+		int y = board_size_.y / 2;
+		for (int i = 0; i < 3; ++i) cells[(y + i) * board_size_.x + x] = up;
+
+		head_x_[game]    = x;
+		head_y_[game]    = y;
+		tail_x_[game]    = x;
+		tail_y_[game]    = y + 2;
+		direction_[game] = std::uint8_t(Direction::up);
+		length_[game]    = 3;
+		score_[game]     = 0;
+		alive_[game]     = 1;
+		spawnFruit(game);
+	}
+
+	bool BatchEnv::spawnFruit(int game) {
+		std::uint8_t const * cells = board(game);
+		Pcg32 & generator = generators_[game];
+
+		for (int attempt = 0; attempt < fruit_attempts; ++attempt) {
+			int cell = (std::uint64_t(generator()) * cells_per_game_) >> 32;
+			if (cells[cell] == 0) {
+				fruit_x_[game] = cell % board_size_.x;
+				fruit_y_[game] = cell / board_size_.x;
+				return true;
+			}
+		}
+
+		// The board is crowded, scan for a free cell from a random starting point.
+		int start = (std::uint64_t(generator()) * cells_per_game_) >> 32;
+		for (int i = 0; i < cells_per_game_; ++i) {
+			int cell = (start + i) % cells_per_game_;
+			if (cells[cell] == 0) {
+				fruit_x_[game] = cell % board_size_.x;
+				fruit_y_[game] = cell / board_size_.x;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void BatchEnv::step(Action const * actions, float * rewards, std::uint8_t * done) {
+		// First pass: compute the new directions and head positions of all games.
+		// This is plain arithmetic on the arrays, without branches, so the compiler can vectorize it.
+		std::uint32_t width  = board_size_.x;
+		std::uint32_t height = board_size_.y;
+		for (int i = 0; i < count_; ++i) {
+			std::uint8_t current   = direction_[i];
+			std::uint8_t requested = action_direction[int(actions[i])];
+			std::uint8_t keep      = (requested == 4) | (requested == std::uint8_t(-Direction(current)));
+			std::uint8_t direction = keep ? current : requested;
+
+			Vector2 step   = directionVector(Direction(direction));
+			std::int32_t x = head_x_[i] + step.x;
+			std::int32_t y = head_y_[i] + step.y;
+			next_direction_[i] = direction;
+			next_x_[i]         = x;
+			next_y_[i]         = y;
+			valid_[i]          = (std::uint32_t(x) < width) & (std::uint32_t(y) < height);
+		}
+
+		// Second pass: apply the moves to the boards.
+		for (int i = 0; i < count_; ++i) {
+			if (!alive_[i]) {
+				if (rewards) rewards[i] = 0;
+				if (done)    done[i]    = 1;
+				continue;
+			}
+
+			std::uint8_t * cells = board(i);
+			bool eating = next_x_[i] == fruit_x_[i] && next_y_[i] == fruit_y_[i];
+			float reward = 0;
+			bool ended   = false;
+
+			int head_cell = next_y_[i] * board_size_.x + next_x_[i];
+			int tail_cell = tail_y_[i] * board_size_.x + tail_x_[i];
+			if (!valid_[i] || (cells[head_cell] != 0 && (head_cell != tail_cell || eating))) {
+				reward = -1;
+				ended  = true;
+			} else {
+				// Record the direction the snake leaves the old head in, so the tail can follow it later.
+				std::uint8_t direction = next_direction_[i];
+				cells[head_y_[i] * board_size_.x + head_x_[i]] = 1 + direction;
+
+				if (!eating) {
+					Vector2 tail_step = directionVector(Direction(cells[tail_cell] - 1));
+					cells[tail_cell] = 0;
+					tail_x_[i] += tail_step.x;
+					tail_y_[i] += tail_step.y;
+				}
+
+				cells[head_cell] = 1 + direction;
+				head_x_[i]       = next_x_[i];
+				head_y_[i]       = next_y_[i];
+				direction_[i]    = direction;
+
+				if (eating) {
+					reward      = 1;
+					score_[i]  += 1;
+					length_[i] += 1;
+					ended = !spawnFruit(i);
+				}
+			}
+
+			if (rewards) rewards[i] = reward;
+			if (done)    done[i]    = ended;
+			if (ended) {
+				alive_[i] = 0;
+				if (auto_reset_) reset(i);
+			}
+		}
+	}
+
+	void BatchEnv::observe(std::uint8_t * output) const {
+		std::size_t plane = cells_per_game_;
+		for (int i = 0; i < count_; ++i) {
+			std::uint8_t * body  = output + std::size_t(i) * channels * plane;
+			std::uint8_t * head  = body + plane;
+			std::uint8_t * fruit = head + plane;
+			std::uint8_t const * cells = board(i);
+
+			for (std::size_t c = 0; c < plane; ++c) body[c] = cells[c] != 0;
+			std::memset(head,  0, plane);
+			std::memset(fruit, 0, plane);
+			head[head_y_[i] * board_size_.x + head_x_[i]]    = 1;
+			fruit[fruit_y_[i] * board_size_.x + fruit_x_[i]] = 1;
+		}
+	}
+
+	void BatchEnv::observe(float * output) const {
+		std::size_t plane = cells_per_game_;
+		for (int i = 0; i < count_; ++i) {
+			float * body  = output + std::size_t(i) * channels * plane;
+			float * head  = body + plane;
+			float * fruit = head + plane;
+			std::uint8_t const * cells = board(i);
+
+			for (std::size_t c = 0; c < plane; ++c) {
+				body[c]  = cells[c] != 0;
+				head[c]  = 0;
+				fruit[c] = 0;
+			}
+			head[head_y_[i] * board_size_.x + head_x_[i]]    = 1;
+			fruit[fruit_y_[i] * board_size_.x + fruit_x_[i]] = 1;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+#include "random.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace snake {
+	/// Many games of the same board size stepped in lockstep, stored as a structure of arrays.
+	/**
+	 * Heads, tails, directions, scores, alive flags and fruit positions live in contiguous arrays
+	 * indexed by game, and the boards of all games share one arena with one byte per cell.
+	 * A cell is zero when free, and otherwise holds one plus the direction the snake left the cell in,
+	 * so the tail can follow the body without a segment list.
+	 *
+	 * By default, games that end are reset at the end of the same step, so every game is always running.
+	 * Without automatic resets, ended games keep their final state and are skipped until they are reset.
+	 * The rules match Game, but fruit is placed by rejection sampling with a linear scan as fallback,
+	 * so the random fruit positions differ from Game for the same seed.
+	 */
+	class BatchEnv {
+	public:
+		/// The number of observation planes per game: body, head and fruit.
+		static constexpr int channels = 3;
+
+	private:
+		int count_;
+		Vector2 board_size_;
+		bool auto_reset_;
+		int cells_per_game_;
+
+		std::vector<std::int32_t> head_x_;
+		std::vector<std::int32_t> head_y_;
+		std::vector<std::int32_t> tail_x_;
+		std::vector<std::int32_t> tail_y_;
+		std::vector<std::int32_t> fruit_x_;
+		std::vector<std::int32_t> fruit_y_;
+		std::vector<std::int32_t> score_;
+		std::vector<std::int32_t> length_;
+		std::vector<std::uint8_t> direction_;
+		std::vector<std::uint8_t> alive_;
+		std::vector<Pcg32> generators_;
+
+		/// The boards of all games, one after another.
+		std::vector<std::uint8_t> cells_;
+
+		/// Per step scratch space for the candidate head positions.
+		std::vector<std::int32_t> next_x_;
+		std::vector<std::int32_t> next_y_;
+		std::vector<std::uint8_t> next_direction_;
+		std::vector<std::uint8_t> valid_;
+
+		std::uint8_t * board(int game) { return &cells_[std::size_t(game) * cells_per_game_]; }
+		std::uint8_t const * board(int game) const { return &cells_[std::size_t(game) * cells_per_game_]; }
+
+		/// Place fruit on a free cell. Returns false if the board is full.
+		bool spawnFruit(int game);
+
+	public:
+		/// Create a number of games, with generators seeded from a master seed and the game index.
+		BatchEnv(int count, Vector2 const & board_size, std::uint64_t seed, bool auto_reset = true);
+
+		/// Get the number of games.
+		int size() const { return count_; }
+
+		/// Get the board size of all games.
+		Vector2 const & boardSize() const { return board_size_; }
+
+		/// Reset all games.
+		void reset();
+
+		/// Reset a single game.
+		void reset(int game);
+
+		/// Advance all games by one tick.
+		/**
+		 * Takes one action per game. Action::none and Action::reset keep the current direction.
+		 * If not null, a reward per game (+1 for fruit, -1 for dying) and a done flag per game are written.
+		 * With automatic resets, games that are done are reset before this function returns.
+		 * Otherwise, games that already ended get a zero reward and stay done.
+		 */
+		void step(Action const * actions, float * rewards = nullptr, std::uint8_t * done = nullptr);
+
+		/// Write observations of all games in [game][channel][y][x] order, with 1 for set cells and 0 otherwise.
+		void observe(std::uint8_t * output) const;
+
+		/// Write observations of all games in [game][channel][y][x] order, with 1 for set cells and 0 otherwise.
+		void observe(float * output) const;
+
+		std::int32_t const * headX()  const { return head_x_.data(); }
+		std::int32_t const * headY()  const { return head_y_.data(); }
+		std::int32_t const * fruitX() const { return fruit_x_.data(); }
+		std::int32_t const * fruitY() const { return fruit_y_.data(); }
+		std::int32_t const * scores() const { return score_.data(); }
+		std::int32_t const * lengths() const { return length_.data(); }
+		std::uint8_t const * alive()  const { return alive_.data(); }
+	};
+}
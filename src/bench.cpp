@@ -0,0 +1,279 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ansi_printer.hpp"
+#include "batch_env.hpp"
+#include "field.hpp"
+#include "field_printer.hpp"
+#include "game.hpp"
+#include "hamiltonian.hpp"
+#include "random.hpp"
+#include "snake.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cursesw.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	struct Options {
+		int max_size    = 4096;
+		double min_time = 0.1;
+	};
+
+	/// Results of benchmarked calls are accumulated here, so the compiler can not drop the calls.
+	volatile std::size_t sink = 0;
+
+	/// Run a benchmark until it took at least the given time, and return the average time per operation in nanoseconds.
+	template<typename F>
+	double measure(double min_time, F && operation) {
+		long long iterations = 1;
+		while (true) {
+			auto start = Clock::now();
+			for (long long i = 0; i < iterations; ++i) operation();
+			double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			if (elapsed >= min_time) return elapsed * 1e9 / iterations;
+			iterations *= 2;
+		}
+	}
+
+	void report(char const * name, snake::Vector2 board_size, int length, double nanoseconds) {
+		std::printf("%-24s %5dx%-5d %10d %14.1f\n", name, board_size.x, board_size.y, length, nanoseconds);
+		std::fflush(stdout);
+	}
+
+	/// Get the action that follows a Hamiltonian cycle.
+	snake::Action cycleAction(snake::HamiltonianCycle const & cycle, snake::Game const & game) {
+		return snake::directionAction(cycle.next(game.snake.head));
+	}
+
+	/// Create a game with a snake of a given length laid out along a Hamiltonian cycle.
+	snake::Game makeGame(snake::HamiltonianCycle const & cycle, int length, snake::DefaultGenerator & generator) {
+		snake::Vector2 board_size = cycle.size();
+		snake::Game game;
+		game.board_size = board_size;
+		game.reset(generator);
+
+		game.snake.reset(board_size, {0, 0}, snake::Segment{snake::Direction::up, 1});
+		for (int i = 1; i < length; ++i) {
+			game.snake.moveHead(cycle.next(game.snake.head));
+		}
+		game.score = length - 3;
+		if (!game.spawnFruit(generator)) game.fruit = game.snake.head;
+		return game;
+	}
+
+	/// Render a game on a field.
+	void drawGame(snake::Field & field, snake::Game const & game) {
+		field.clear();
+		drawPoint(field, game.fruit, snake::Color::yellow);
+		drawSnake(field, game.snake);
+	}
+
+	/// Benchmark the simulation for a board size and snake length.
+	void benchSimulation(Options const & options, snake::HamiltonianCycle const & cycle, int length) {
+		snake::Vector2 board_size = cycle.size();
+		snake::DefaultGenerator generator(1);
+		snake::Game const start = makeGame(cycle, length, generator);
+
+		snake::Game game = start;
+		report("Game::doTick", board_size, length, measure(options.min_time, [&] () {
+			if (!game.alive) game = start;
+			game.doTick(cycleAction(cycle, game), generator);
+		}));
+
+		std::vector<snake::Vector2> points(1024);
+		std::uniform_int_distribution<int> random_x(0, board_size.x - 1);
+		std::uniform_int_distribution<int> random_y(0, board_size.y - 1);
+		for (auto & point : points) point = {random_x(generator), random_y(generator)};
+
+		std::size_t next = 0;
+		report("pointCollidesWithSnake", board_size, length, measure(options.min_time, [&] () {
+			sink = sink + pointCollidesWithSnake(points[next++ % points.size()], start.snake);
+		}));
+
+		game = start;
+		report("Game::spawnFruit", board_size, length, measure(options.min_time, [&] () {
+			game.spawnFruit(generator);
+		}));
+
+		std::vector<unsigned char> state;
+		start.serialize(state, generator);
+		report("Game::serialize", board_size, length, measure(options.min_time, [&] () {
+			state.clear();
+			start.serialize(state, generator);
+		}));
+
+		snake::DefaultGenerator fork_generator;
+		report("Game::deserialize", board_size, length, measure(options.min_time, [&] () {
+			game.deserialize(state.data(), state.size(), fork_generator);
+		}));
+
+		report("Game copy", board_size, length, measure(options.min_time, [&] () {
+			game = start;
+		}));
+
+		snake::Field field(board_size);
+		report("drawSnake", board_size, length, measure(options.min_time, [&] () {
+			drawSnake(field, start.snake);
+		}));
+	}
+
+	/// Benchmark stepping a batch of games in lockstep, reported per game step.
+	/**
+	 * The batch is kept to about 16 million cells, so the large boards run as a few games or one.
+	 * The actions are random and games reset automatically, so the snakes stay short.
+	 */
+	void benchBatch(Options const & options, snake::Vector2 board_size) {
+		int games = std::max(1, std::min(1024, (1 << 24) / (board_size.x * board_size.y)));
+		snake::BatchEnv env(games, board_size, 1);
+
+		snake::DefaultGenerator generator(1);
+		std::vector<snake::Action> actions(std::size_t(games) * 64);
+		for (auto & action : actions) action = snake::Action(generator() % 5);
+		std::vector<float> rewards(games);
+		std::vector<std::uint8_t> done(games);
+
+		std::size_t round = 0;
+		double nanoseconds = measure(options.min_time, [&] () {
+			env.step(&actions[(round++ % 64) * games], rewards.data(), done.data());
+			sink += done[0];
+		});
+		report("BatchEnv::step", board_size, 3, nanoseconds / games);
+	}
+
+	/// Benchmark printing fields to an off-screen curses pad.
+	void benchPrinting(Options const & options, snake::HamiltonianCycle const & cycle, int length) {
+		snake::Vector2 board_size = cycle.size();
+		snake::DefaultGenerator generator(1);
+		snake::Game game = makeGame(cycle, length, generator);
+
+		snake::Field before(board_size);
+		snake::Field after(board_size);
+		drawGame(before, game);
+		game.doTick(cycleAction(cycle, game), generator);
+		drawGame(after, game);
+
+		WINDOW * pad = newpad(board_size.y / 2 + 1, board_size.x + 1);
+		if (!pad) {
+			std::cerr << "failed to create a curses pad for a " << board_size.x << "x" << board_size.y << " board\n";
+			return;
+		}
+
+		std::vector<std::uint8_t> pairs(board_size.x);
+		report("colorPairRow field", board_size, length, measure(options.min_time, [&] () {
+			for (int y = 0; y < board_size.y; y += 2) colorPairRow(before, y, pairs.data());
+			sink = sink + pairs[0];
+		}));
+
+		snake::FieldPrinter printer;
+		report("printField full", board_size, length, measure(options.min_time, [&] () {
+			printer.invalidate();
+			printer.print(pad, 0, 0, before);
+		}));
+
+		bool flip = false;
+		report("printField tick", board_size, length, measure(options.min_time, [&] () {
+			printer.print(pad, 0, 0, flip ? before : after);
+			flip = !flip;
+		}));
+
+		delwin(pad);
+
+		int null = open("/dev/null", O_WRONLY);
+		if (null < 0) return;
+		snake::AnsiPrinter ansi_printer(null);
+		report("AnsiPrinter full", board_size, length, measure(options.min_time, [&] () {
+			ansi_printer.invalidate();
+			ansi_printer.print(0, 0, before);
+		}));
+
+		flip = false;
+		report("AnsiPrinter tick", board_size, length, measure(options.min_time, [&] () {
+			ansi_printer.print(0, 0, flip ? before : after);
+			flip = !flip;
+		}));
+		close(null);
+	}
+
+	bool parseOptions(int argc, char * * argv, Options & options) {
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (i + 1 >= argc) {
+				std::cerr << "missing value for option: " << option << "\n";
+				return false;
+			}
+			char const * value = argv[++i];
+			if      (option == "--max-size") options.max_size = std::atoi(value);
+			else if (option == "--min-time") options.min_time = std::atof(value);
+			else {
+				std::cerr << "unknown option: " << option << "\n";
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char * * argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		std::cerr << "usage: " << argv[0] << " [--max-size N] [--min-time SECONDS]\n";
+		return 1;
+	}
+
+	// Curses renders into pads only, so send all terminal output to /dev/null.
+	std::FILE * null_out = std::fopen("/dev/null", "w");
+	std::FILE * null_in  = std::fopen("/dev/null", "r");
+	SCREEN * screen = nullptr;
+	if (null_out && null_in) screen = newterm("xterm-256color", null_out, null_in);
+	if (!screen) std::cerr << "failed to initialize curses, skipping printField benchmarks\n";
+
+	std::printf("%-24s %11s %10s %14s\n", "benchmark", "board", "length", "ns/op");
+
+	int const sizes[]    = {20, 64, 256, 1024, 4096};
+	double const fills[] = {0.0, 0.1, 0.5, 0.9, 0.99};
+	for (int size : sizes) {
+		if (size > options.max_size) continue;
+		// Not the shared cycle from HamiltonianCycle::get(), so the cycles of the large boards are freed again.
+		snake::HamiltonianCycle cycle({size, size});
+		for (double fill : fills) {
+			int length = std::max(3, int(fill * size * size));
+			benchSimulation(options, cycle, length);
+			if (screen) benchPrinting(options, cycle, length);
+		}
+		benchBatch(options, {size, size});
+	}
+
+	if (screen) {
+		endwin();
+		delscreen(screen);
+	}
+}
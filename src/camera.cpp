@@ -0,0 +1,72 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "camera.hpp"
+
+#include <algorithm>
+
+namespace snake {
+	namespace {
+		/// Scroll the camera along one axis and keep it inside the board.
+		int followAxis(int origin, int point, int view, int board) {
+			int margin = view / 4;
+			if (point < origin + margin)         origin = point - margin;
+			if (point >= origin + view - margin) origin = point - view + margin + 1;
+			return std::max(0, std::min(origin, board - view));
+		}
+	}
+
+	Camera::Camera(Vector2 const & board_size, Vector2 const & size) : board_size_(board_size) {
+		resize(size);
+	}
+
+	void Camera::resize(Vector2 const & size) {
+		size_.x   = std::max(0, std::min(size.x, board_size_.x));
+		size_.y   = std::max(0, std::min(size.y, board_size_.y));
+		origin_.x = std::max(0, std::min(origin_.x, board_size_.x - size_.x));
+		origin_.y = std::max(0, std::min(origin_.y, board_size_.y - size_.y));
+	}
+
+	void Camera::follow(Vector2 const & point) {
+		origin_.x = followAxis(origin_.x, point.x, size_.x, board_size_.x);
+		origin_.y = followAxis(origin_.y, point.y, size_.y, board_size_.y);
+	}
+
+	void drawView(Field & field, Camera const & camera, Game const & game) {
+		Vector2 const & origin  = camera.origin();
+		Occupancy const & cells = game.snake.occupancy;
+		for (int y = 0; y < camera.size().y; ++y) {
+			for (int x = 0; x < camera.size().x; ++x) {
+				bool occupied = cells.occupied(origin + Vector2{x, y});
+				field.setPixel(x, y, occupied ? Color::white : Color::black);
+			}
+		}
+
+		Vector2 fruit = game.fruit - origin;
+		if (!game.won && pointInsideArea(fruit, camera.size())) drawPoint(field, fruit, Color::yellow);
+	}
+
+	void drawView(Field & field, Camera const & camera, Field const & board) {
+		Vector2 const & origin = camera.origin();
+		for (int y = 0; y < camera.size().y; ++y) {
+			for (int x = 0; x < camera.size().x; ++x) {
+				field.setPixel(x, y, board.pixel(origin.x + x, origin.y + y));
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "field.hpp"
+#include "game.hpp"
+#include "geometry.hpp"
+
+namespace snake {
+	/// A window on the board that follows a point, for boards larger than the screen.
+	/**
+	 * The camera is never larger than the board and never shows anything outside of it.
+	 * It only scrolls when the followed point comes within a quarter of the view size of an edge,
+	 * so the picture does not shift on every tick.
+	 */
+	class Camera {
+		Vector2 board_size_;
+		Vector2 size_;
+		Vector2 origin_ = {0, 0};
+
+	public:
+		/// Create a camera with a view size for a board, showing the top left corner of the board.
+		Camera(Vector2 const & board_size, Vector2 const & size);
+
+		/// Get the size of the view, which may be smaller than requested.
+		Vector2 const & size() const { return size_; }
+
+		/// Get the board position of the top left corner of the view.
+		Vector2 const & origin() const { return origin_; }
+
+		/// Change the size of the view, keeping it inside the board.
+		void resize(Vector2 const & size);
+
+		/// Scroll the view so a point stays away from the edges, as far as the board allows.
+		void follow(Vector2 const & point);
+	};
+
+	/// Draw the part of a game inside a camera view on a field of the view size.
+	/**
+	 * The snake is drawn from the occupancy grid rather than by walking its segments,
+	 * so the cost only depends on the size of the view.
+	 */
+	void drawView(Field & field, Camera const & camera, Game const & game);
+
+	/// Copy the part of a board sized field inside a camera view to a field of the view size.
+	void drawView(Field & field, Camera const & camera, Field const & board);
+}
@@ -0,0 +1,77 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "field.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace snake {
+	void drawPoint(Field & field, Vector2 const & location, Color const & color) {
+		field.setPixel(location, color);
+	}
+
+	Vector2 drawLine(Field & field, Line const & line) {
+		Vector2 point = line.start;
+		for (int i = 0; i < line.length; ++i) {
+			field.setPixel(point, Color::white);
+			point = point + directionVector(line.direction);
+		}
+		return point;
+	}
+
+	void drawSnake(Field & field, Snake const & snake) {
+		Vector2 start = snake.head;
+		for (unsigned int i = 0; i < snake.segments.size(); ++i) {
+			Segment const & segment = snake.segments[i];
+			start = drawLine(field, Line{start, -segment.direction, segment.length});
+		}
+	}
+
+	void colorPairRow(Field const & field, int y, std::uint8_t * pairs) {
+		int const width = field.size().x;
+		std::uint8_t const * top    = field.packedRow(y);
+		std::uint8_t const * bottom = y + 1 < field.size().y ? field.packedRow(y + 1) : nullptr;
+
+		int x = 0;
+#ifdef __SSE2__
+		__m128i const nibble = _mm_set1_epi8(0xf);
+		__m128i const one    = _mm_set1_epi8(1);
+		for (; x + 32 <= width; x += 32) {
+			__m128i upper = _mm_loadu_si128(reinterpret_cast<__m128i const *>(top + x / 2));
+			__m128i lower = bottom ? _mm_loadu_si128(reinterpret_cast<__m128i const *>(bottom + x / 2)) : _mm_setzero_si128();
+
+			// Colors are at most 7, so shifting 16 bit lanes never carries into the neighbouring byte.
+			__m128i upper_even = _mm_slli_epi16(_mm_and_si128(upper, nibble), 3);
+			__m128i upper_odd  = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(upper, 4), nibble), 3);
+			__m128i lower_even = _mm_and_si128(lower, nibble);
+			__m128i lower_odd  = _mm_and_si128(_mm_srli_epi16(lower, 4), nibble);
+
+			__m128i even = _mm_add_epi8(_mm_add_epi8(upper_even, lower_even), one);
+			__m128i odd  = _mm_add_epi8(_mm_add_epi8(upper_odd,  lower_odd),  one);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pairs + x),      _mm_unpacklo_epi8(even, odd));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pairs + x + 16), _mm_unpackhi_epi8(even, odd));
+		}
+#endif
+		for (; x < width; ++x) {
+			Color lower = bottom ? field.pixel(x, y + 1) : Color::black;
+			pairs[x] = colorIndex(field.pixel(x, y), lower);
+		}
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "geometry.hpp"
+#include "snake.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace snake {
+	/// Color definitions.
+	enum class Color : unsigned char {
+		black,
+		red,
+		green,
+		yellow,
+		blue,
+		magenta,
+		cyan,
+		white,
+	};
+
+	/// Get the color pair index for a foreground and background color.
+	inline int colorIndex(Color fg, Color bg) {
+		return int(fg) * 8 + int(bg) + 1;
+	};
+
+	/// A playing field.
+	/**
+	 * Pixels are packed as four bit colors, two per byte, with even columns in the low nibble.
+	 * Three bits would be enough for the eight colors, but nibbles keep every pixel inside one byte.
+	 * Each row starts on a new byte.
+	 */
+	class Field {
+		Vector2 size_;
+		int stride_;
+		std::vector<std::uint8_t> data_;
+
+		static std::uint8_t fill(Color color) { return std::uint8_t(color) | std::uint8_t(color) << 4; }
+
+	public:
+		Field(Vector2 const & size) : size_(size), stride_((size.x + 1) / 2), data_(stride_ * size.y, fill(Color::black)) {}
+		Field(int x, int y) : Field(Vector2{x, y}) {};
+
+		/// Get the size of the field.
+		Vector2 const & size() const { return size_; }
+
+		/// Change the size of the field and clear it.
+		/**
+		 * The buffer keeps its capacity, so shrinking or growing back to an earlier size does not allocate.
+		 */
+		void resize(Vector2 const & size) {
+			size_   = size;
+			stride_ = (size.x + 1) / 2;
+			data_.assign(stride_ * size.y, fill(Color::black));
+		}
+
+		/// Get the value of a pixel in a field.
+		Color pixel(int x, int y) const {
+			return Color(data_[y * stride_ + x / 2] >> (x & 1) * 4 & 0xf);
+		}
+
+		Color pixel(Vector2 const & location) const { return pixel(location.x, location.y); }
+
+		/// Set the value of a pixel in a field.
+		void setPixel(int x, int y, Color color) {
+			std::uint8_t & byte = data_[y * stride_ + x / 2];
+			int shift = (x & 1) * 4;
+			byte = (byte & ~(0xf << shift)) | std::uint8_t(color) << shift;
+		}
+
+		void setPixel(Vector2 const & location, Color color) { setPixel(location.x, location.y, color); }
+
+		/// Get the packed pixels of a row.
+		std::uint8_t const * packedRow(int y) const { return &data_[y * stride_]; }
+
+		/// Clear the field with a single color.
+		void clear(Color const & color = Color::black) {
+			data_.assign(data_.size(), fill(color));
+		}
+	};
+
+	/// Get the color pair indices for a row of terminal cells.
+	/**
+	 * Each terminal cell shows pixel row y on top and row y + 1 below, or black below for the last row of an odd sized field.
+	 * Writes field.size().x pair indices as computed by colorIndex(top, bottom).
+	 * Uses SSE2 when available, converting 32 pixels per step.
+	 */
+	void colorPairRow(Field const & field, int y, std::uint8_t * pairs);
+
+	/// Draw a point on a field.
+	void drawPoint(Field & field, Vector2 const & location, Color const & color);
+
+	/// Draw a line on a field. Returns the end point of the line.
+	Vector2 drawLine(Field & field, Line const & line);
+
+	/// Draw a snake on a field.
+	void drawSnake(Field & field, Snake const & snake);
+}
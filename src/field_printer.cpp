@@ -0,0 +1,63 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "field_printer.hpp"
+
+namespace snake {
+	std::uint32_t const upper_block = U'\u2580';
+	std::uint32_t const lower_block = U'\u2584';
+	std::uint32_t const full_block  = U'\u2588';
+	std::uint32_t const empty_block = U'\u0020';
+
+	void FieldPrinter::print(WINDOW * window, int start_y, int start_x, Field const & field) {
+		int const width = field.size().x;
+		int const rows  = (field.size().y + 1) / 2;
+
+		if (field.size() != size_) {
+			cchar_t blank  = {};
+			blank.chars[0] = upper_block;
+			size_        = field.size();
+			pairs_.assign(width, 0);
+			previous_.assign(std::size_t(width) * rows, 0);
+			row_.assign(width, blank);
+			full_redraw_ = true;
+		}
+
+		for (int row = 0; row < rows; ++row) {
+			colorPairRow(field, row * 2, pairs_.data());
+			std::uint8_t * previous = &previous_[std::size_t(row) * width];
+
+			// Find the span of changed cells in this row.
+			int first = 0;
+			int last  = width - 1;
+			if (!full_redraw_) {
+				while (first <= last && pairs_[first] == previous[first]) ++first;
+				while (last >= first && pairs_[last]  == previous[last])  --last;
+				if (first > last) continue;
+			}
+
+			for (int x = first; x <= last; ++x) {
+				row_[x].attr = COLOR_PAIR(pairs_[x]);
+				previous[x]  = pairs_[x];
+			}
+			mvwadd_wchnstr(window, start_y + row, start_x + first, &row_[first], last - first + 1);
+		}
+
+		full_redraw_ = false;
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "field.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <cursesw.h>
+
+namespace snake {
+	extern std::uint32_t const upper_block;
+	extern std::uint32_t const lower_block;
+	extern std::uint32_t const full_block;
+	extern std::uint32_t const empty_block;
+
+	/// Prints fields to a curses window, only emitting the cells that changed since the previous frame.
+	/**
+	 * Each terminal cell shows two vertically stacked pixels of the field.
+	 * Every terminal row is converted to color pair indices with colorPairRow(),
+	 * and compared against the pair indices printed for that row in the previous frame.
+	 * The changed part of each terminal row is written with a single curses call
+	 * from a row buffer that is reused between frames.
+	 */
+	class FieldPrinter {
+		Vector2 size_{0, 0};
+		std::vector<std::uint8_t> pairs_;
+		std::vector<std::uint8_t> previous_;
+		std::vector<cchar_t> row_;
+		bool full_redraw_ = true;
+
+	public:
+		/// Make the next call to print() redraw every cell.
+		void invalidate() { full_redraw_ = true; }
+
+		/// Print a field to a window.
+		void print(WINDOW * window, int start_y, int start_x, Field const & field);
+	};
+}
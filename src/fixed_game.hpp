@@ -0,0 +1,95 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+#include "snake.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace snake {
+	/// A board size known at compile time, which converts to a constant Vector2.
+	template<int Width, int Height>
+	struct FixedSize {
+		constexpr operator Vector2() const { return {Width, Height}; }
+	};
+
+	/// A vector with its storage inline, for lists with a bounded length.
+	template<typename T, std::size_t Capacity>
+	class FixedVector {
+		std::array<T, Capacity> data_;
+		std::size_t size_ = 0;
+
+	public:
+		std::size_t size() const { return size_; }
+		void clear() { size_ = 0; }
+		void resize(std::size_t size) { size_ = size; }
+		void push_back(T const & value) { data_[size_++] = value; }
+		void pop_back() { --size_; }
+
+		T & back() { return data_[size_ - 1]; }
+		T const & back() const { return data_[size_ - 1]; }
+		T & operator[](std::size_t i) { return data_[i]; }
+		T const & operator[](std::size_t i) const { return data_[i]; }
+	};
+
+	/// Storage for a board with a size known at compile time.
+	/**
+	 * All grids are stored inline, and indexing uses the constant width,
+	 * so bounds checks and cell indexing compile to constant comparisons, multiplications and shifts.
+	 * Cell indices are as small as the board allows, to keep the grids small.
+	 */
+	template<int Width, int Height>
+	struct FixedStorage {
+		static constexpr int cell_count = Width * Height;
+		static_assert(Width > 0 && Height > 0 && cell_count <= 65536, "the board must have between 1 and 65536 cells");
+
+		using Size  = FixedSize<Width, Height>;
+		using Index = typename std::conditional<cell_count <= 256, std::uint8_t, std::uint16_t>::type;
+
+		template<typename T> using Grid = std::array<T, cell_count>;
+		template<typename T> using List = FixedVector<T, cell_count>;
+
+		/// The size is fixed, callers always pass the same size.
+		static void setSize(Size &, Vector2 const &) {}
+
+		template<typename T>
+		static void resizeGrid(Grid<T> &, std::size_t) {}
+	};
+
+	/// Per-cell occupancy counters for a board with a size known at compile time.
+	template<int Width, int Height>
+	using FixedOccupancy = BasicOccupancy<FixedStorage<Width, Height>>;
+
+	/// A snake with an occupancy grid for a board with a size known at compile time.
+	template<int Width, int Height>
+	using FixedSnake = BasicSnake<FixedStorage<Width, Height>>;
+
+	/// A snake game on a board with a size known at compile time.
+	/**
+	 * Plays exactly like Game on a board of the same size, since both share the rules of BasicGame.
+	 * There is no message string and no saving, since the game is meant for headless batches.
+	 */
+	template<int Width, int Height>
+	using FixedGame = BasicGame<FixedStorage<Width, Height>>;
+}
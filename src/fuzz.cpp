@@ -0,0 +1,554 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "autopilot.hpp"
+#include "batch_env.hpp"
+#include "fixed_game.hpp"
+#include "game.hpp"
+#include "game_state.hpp"
+#include "hamiltonian.hpp"
+#include "random.hpp"
+#include "snake.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	/// What the fuzzer is doing, to report along with a failed invariant.
+	struct Context {
+		std::uint64_t seed = 0;
+		std::uint64_t tick = 0;
+		char const * stream = "";
+	};
+
+	Context context;
+
+	/// Abort with a report about a violated invariant.
+	[[noreturn]] void fail(char const * invariant) {
+		std::fprintf(stderr, "invariant violated: %s\n", invariant);
+		std::fprintf(stderr, "  stream %s, seed %llu, tick %llu\n", context.stream, (unsigned long long) context.seed, (unsigned long long) context.tick);
+		std::abort();
+	}
+
+	/// Abort with a report if an invariant does not hold.
+	/**
+	 * This runs a few hundred times per tick, so the report is kept out of line.
+	 */
+	inline void require(bool condition, char const * invariant) {
+		if (!condition) fail(invariant);
+	}
+
+	/// Checks the invariants of a game after every tick.
+	/**
+	 * The checks are run against simple reference implementations:
+	 * every tick is replayed on a copy of the snake body, collisions use pointCollidesWithSnake(),
+	 * and the occupancy grid is rebuilt by walking the segments.
+	 * Checks that walk the snake run every tick, checks that walk the whole board are sampled with checkGrid().
+	 * The scratch buffers are reused, so checking does not allocate once the board size settles.
+	 */
+	class Checker {
+		std::vector<unsigned char> counts_;
+		std::vector<unsigned char> state_;
+		snake::Game restored_;
+		snake::Pcg32 restored_generator_;
+
+		/// The snake body after the predicted tick, and the predicted outcome.
+		snake::SnakeBody reference_;
+		snake::Vector2 head_before_;
+		bool predicted_ = false;
+		bool dies_      = false;
+		bool wins_      = false;
+		snake::DeathCause death_cause_ = snake::DeathCause::none;
+
+	public:
+		/// Predict the outcome of the next tick of a live game, before the tick is done.
+		/**
+		 * The body is copied and moved by hand: the head moves, the tail follows unless the snake eats,
+		 * and the snake dies if the new head lies outside the board or on the rest of the moved body.
+		 * A dead game only changes on a reset, which checkReset() covers.
+		 */
+		void predict(snake::Game const & game, snake::Action action) {
+			predicted_ = game.alive;
+			if (!predicted_) return;
+
+			snake::Direction current   = game.snake.segments.front().direction;
+			snake::Direction direction = current;
+			if (action >= snake::Action::up && action <= snake::Action::right) {
+				snake::Direction steer = snake::Direction(int(action) - int(snake::Action::up));
+				if (steer != -current) direction = steer;
+			}
+
+			head_before_ = game.snake.head;
+			reference_   = game.snake;
+			snake::Vector2 head = head_before_ + snake::directionVector(direction);
+			bool eating = head == game.fruit;
+			reference_.moveHead(direction);
+			if (!eating) reference_.shrinkTail();
+
+			bool wall    = !snake::pointInsideArea(head, game.board_size);
+			dies_        = wall || snake::pointCollidesWithSnake(head, reference_, false);
+			death_cause_ = !dies_ ? snake::DeathCause::none : wall ? snake::DeathCause::wall : snake::DeathCause::self;
+			wins_        = !dies_ && eating && reference_.length == game.board_size.x * game.board_size.y;
+		}
+
+		/// Check the outcome of a tick against the prediction made before it.
+		void checkPrediction(snake::Game const & game) {
+			if (!predicted_) return;
+			require(game.alive == (!dies_ && !wins_), "the snake dies like the reference snake");
+			require(game.won == wins_, "the game is won when the reference snake fills the board");
+			require(game.death_cause == death_cause_, "the death cause matches the reference snake");
+			if (dies_) {
+				require(game.snake.head == head_before_, "a collision leaves the snake where it was");
+			} else {
+				snake::Snake const & snake = game.snake;
+				require(snake.head == reference_.head && snake.tail == reference_.tail && snake.length == reference_.length, "the snake moves like the reference snake");
+			}
+		}
+
+		/// Check a game, and pick a few extra points to compare the occupancy grid against pointCollidesWithSnake().
+		/**
+		 * This takes time proportional to the length of the snake.
+		 */
+		template<typename Generator>
+		void check(snake::Game const & game, Generator & points) {
+			snake::Vector2 const size = game.board_size;
+			snake::Snake const & snake = game.snake;
+			snake::Occupancy const & occupancy = snake.occupancy;
+			require(occupancy.size() == size, "the occupancy grid has the size of the board");
+
+			// Walk the segments from the head.
+			require(snake.segments.size() > 0, "the snake has at least one segment");
+			int length = 0;
+			snake::Vector2 point = snake.head;
+			snake::Vector2 last  = point;
+			for (std::size_t i = 0; i < snake.segments.size(); ++i) {
+				snake::Segment const & segment = snake.segments[i];
+				require(segment.length > 0, "segments are not empty");
+				for (int j = 0; j < segment.length; ++j) {
+					require(snake::pointInsideArea(point, size), "the snake is inside the board");
+					require(occupancy.occupied(point), "the cells of the snake are occupied");
+					last   = point;
+					point -= snake::directionVector(segment.direction);
+				}
+				length += segment.length;
+			}
+			require(length == snake.length, "the segment lengths add up to the snake length");
+			require(last == snake.tail, "the last segment ends at the tail");
+			require(game.score == snake.length - 3, "the score is the number of eaten fruits");
+			require(occupancy.freeCount() == size.x * size.y - snake.length, "every cell off the snake is free");
+
+			if (game.alive) {
+				require(!snake::snakeCollided(snake, size), "a live snake has not collided");
+				require(!snake::pointCollidesWithSnake(game.fruit, snake), "the fruit is never on the snake");
+				require(!occupancy.occupied(game.fruit), "the fruit is on a free cell");
+			}
+			require(game.won == (game.message == snake::win_message), "the message matches the outcome");
+			require(game.won || game.alive != (game.death_cause != snake::DeathCause::none), "dead snakes have a death cause");
+
+			// Spot check the occupancy grid against the reference collision test, including points just outside the board.
+			for (int i = 0; i < 4; ++i) {
+				snake::Vector2 probe = {int(points() % (size.x + 2)) - 1, int(points() % (size.y + 2)) - 1};
+				require(occupancy.occupied(probe) == snake::pointCollidesWithSnake(probe, snake), "the occupancy grid matches pointCollidesWithSnake()");
+			}
+		}
+
+		/// Compare the whole occupancy grid and its free set with the segments.
+		/**
+		 * This takes time proportional to the size of the board, so it is only run now and then.
+		 */
+		void checkGrid(snake::Game const & game) {
+			snake::Vector2 const size = game.board_size;
+			snake::Snake const & snake = game.snake;
+			snake::Occupancy const & occupancy = snake.occupancy;
+
+			// Walk the segments from the head, counting every point.
+			counts_.assign(size.x * size.y, 0);
+			snake::Vector2 point = snake.head;
+			for (std::size_t i = 0; i < snake.segments.size(); ++i) {
+				snake::Segment const & segment = snake.segments[i];
+				for (int j = 0; j < segment.length; ++j) {
+					unsigned char & count = counts_[point.y * size.x + point.x];
+					if (count < 0xff) ++count;
+					point -= snake::directionVector(segment.direction);
+				}
+			}
+
+			// A collision leaves the snake as it was, so the snake never overlaps itself.
+			int free = 0;
+			for (int y = 0; y < size.y; ++y) {
+				for (int x = 0; x < size.x; ++x) {
+					int count = counts_[y * size.x + x];
+					require(count <= 1, "no cell is occupied more than once");
+					require(occupancy.count({x, y}) == count, "the occupancy grid matches the segments");
+					free += count == 0;
+				}
+			}
+			require(occupancy.freeCount() == free, "the free set holds every free cell");
+			for (int i = 0; i < occupancy.freeCount(); ++i) {
+				int cell = occupancy.freeIndex(i);
+				require(cell >= 0 && cell < size.x * size.y, "free cells are inside the board");
+				require(counts_[cell] == 0, "free cells are not occupied and in the free set once");
+				counts_[cell] = 0xff;
+			}
+		}
+
+		/// Check that a reset game is in the initial state.
+		void checkReset(snake::Game const & game) {
+			snake::Vector2 const size = game.board_size;
+			require(game.alive && !game.won && game.score == 0, "a reset game is alive with no score");
+			require(game.death_cause == snake::DeathCause::none && game.message.empty(), "a reset game has no death cause or message");
+			require(game.snake.length == 3 && game.snake.segments.size() == 1, "a reset snake is a single segment of three");
+			require(game.snake.segments.front().direction == snake::Direction::up, "a reset snake moves up");
+			require(game.snake.head == snake::Vector2{size.x / 2, size.y / 2}, "a reset snake starts in the middle");
+			require(game.snake.occupancy.freeCount() == size.x * size.y - 3, "a reset board has all but three cells free");
+		}
+
+		/// Check that saving and restoring a game gives the same game.
+		void checkRoundTrip(snake::Game const & game, snake::Pcg32 const & generator) {
+			state_.clear();
+			game.serialize(state_, generator);
+			restored_.deserialize(state_.data(), state_.size(), restored_generator_);
+
+			snake::Snake const & a = game.snake;
+			snake::Snake const & b = restored_.snake;
+			require(restored_.alive == game.alive && restored_.won == game.won && restored_.death_cause == game.death_cause, "a restored game has the same outcome");
+			require(restored_.score == game.score && restored_.fruit == game.fruit && restored_.message == game.message, "a restored game has the same score, fruit and message");
+			require(a.head == b.head && a.tail == b.tail && a.length == b.length && a.segments.size() == b.segments.size(), "a restored snake has the same shape");
+			for (std::size_t i = 0; i < a.segments.size(); ++i) {
+				require(a.segments[i].direction == b.segments[i].direction && a.segments[i].length == b.segments[i].length, "a restored snake has the same segments");
+			}
+			require(a.occupancy.freeCount() == b.occupancy.freeCount(), "a restored board has the same free cells");
+			for (int i = 0; i < a.occupancy.freeCount(); ++i) {
+				require(a.occupancy.freeIndex(i) == b.occupancy.freeIndex(i), "a restored board has the same order of free cells");
+			}
+			require(restored_generator_() == snake::Pcg32(generator)(), "a restored generator continues the same sequence");
+		}
+	};
+
+	/// Check that a FixedGame is in the same state as the reference Game.
+	template<int Width, int Height>
+	void checkSame(snake::FixedGame<Width, Height> const & fixed, snake::Game const & game) {
+		require(fixed.alive == game.alive && fixed.won == game.won && fixed.death_cause == game.death_cause, "the fixed engine has the same outcome");
+		require(fixed.score == game.score && fixed.fruit == game.fruit, "the fixed engine has the same score and fruit");
+		require(fixed.snake.head == game.snake.head && fixed.snake.tail == game.snake.tail && fixed.snake.length == game.snake.length, "the fixed engine has the same snake");
+		require(fixed.snake.occupancy.freeCount() == game.snake.occupancy.freeCount(), "the fixed engine has the same free cells");
+		for (int i = 0; i < game.snake.occupancy.freeCount(); ++i) {
+			require(fixed.snake.occupancy.freeCell(i) == game.snake.occupancy.freeCell(i), "the fixed engine has the same order of free cells");
+		}
+	}
+
+	/// A FixedGame that plays along with the reference Game on boards of its size.
+	template<int Width, int Height>
+	struct FixedPlayer {
+		snake::FixedGame<Width, Height> game;
+		snake::Pcg32 generator;
+		bool playing = false;
+
+		void start(snake::Game const & reference, std::uint64_t seed) {
+			playing = reference.board_size == snake::Vector2(game.board_size);
+			if (!playing) return;
+			generator.seed(seed);
+			game.reset(generator);
+			checkSame(game, reference);
+		}
+
+		void step(snake::Game const & reference, snake::Action action) {
+			if (!playing) return;
+			game.doTick(action, generator);
+			checkSame(game, reference);
+		}
+	};
+
+	/// Run one action through a game and check it, along with a reset.
+	/**
+	 * The fixed engines only play along on boards of their size, which are all the sizes nsnake-sim instantiates.
+	 * The whole board is compared with the segments every grid_interval ticks and whenever a snake dies.
+	 */
+	struct Runner {
+		static constexpr std::uint64_t grid_interval = 61;
+
+		snake::Game game;
+		snake::Pcg32 generator;
+		FixedPlayer<8, 8> fixed_8;
+		FixedPlayer<20, 20> fixed_20;
+		FixedPlayer<32, 32> fixed_32;
+		FixedPlayer<64, 64> fixed_64;
+		snake::Pcg32 probes;
+		Checker checker;
+		std::uint64_t ticks = 0;
+		std::uint64_t games = 0;
+		std::uint64_t wins  = 0;
+
+		void start(snake::Vector2 board_size, std::uint64_t seed) {
+			game.board_size = board_size;
+			generator.seed(seed);
+			game.reset(generator);
+			checker.checkReset(game);
+			checker.checkGrid(game);
+			fixed_8.start(game, seed);
+			fixed_20.start(game, seed);
+			fixed_32.start(game, seed);
+			fixed_64.start(game, seed);
+		}
+
+		void step(snake::Action action) {
+			bool was_alive = game.alive;
+			checker.predict(game, action);
+			game.doTick(action, generator);
+			fixed_8.step(game, action);
+			fixed_20.step(game, action);
+			fixed_32.step(game, action);
+			fixed_64.step(game, action);
+
+			++ticks;
+			++context.tick;
+			checker.checkPrediction(game);
+			checker.check(game, probes);
+			if (!was_alive && action == snake::Action::reset) checker.checkReset(game);
+			if (was_alive && !game.alive) {
+				++games;
+				wins += game.won;
+			}
+			if (ticks % grid_interval == 0 || (was_alive && !game.alive)) checker.checkGrid(game);
+			if (ticks % 4099 == 0) checker.checkRoundTrip(game, generator);
+		}
+	};
+}
+
+#ifdef NSNAKE_LIBFUZZER
+
+/// Entry point for libFuzzer.
+/**
+ * The first two bytes pick a small board or one of the boards of the fixed engines, the next eight seed the generator,
+ * and every following byte is an action in the low three bits (5 is a reset, 6 and 7 do nothing)
+ * repeated by one more than the high five bits.
+ */
+extern "C" int LLVMFuzzerTestOneInput(std::uint8_t const * data, std::size_t size) {
+	if (size < 10) return 0;
+	static Runner runner;
+
+	std::uint64_t seed = 0;
+	std::memcpy(&seed, data + 2, 8);
+	context = Context{};
+	context.stream = "libfuzzer";
+	context.seed   = seed;
+	static snake::Vector2 const fixed_sizes[] = {{8, 8}, {20, 20}, {32, 32}, {64, 64}};
+	snake::Vector2 board_size = {1 + data[0] % 16, 5 + data[1] % 8};
+	if (board_size.x > 12) board_size = fixed_sizes[board_size.x - 13];
+	runner.start(board_size, seed);
+
+	for (std::size_t i = 10; i < size; ++i) {
+		static snake::Action const actions[] = {
+			snake::Action::none, snake::Action::up, snake::Action::down, snake::Action::left,
+			snake::Action::right, snake::Action::reset, snake::Action::none, snake::Action::none,
+		};
+		snake::Action action = actions[data[i] & 7];
+		for (int repeat = 0; repeat <= data[i] >> 3; ++repeat) runner.step(action);
+	}
+	return 0;
+}
+
+#else
+
+void printUsage(char const * name) {
+	std::fprintf(stderr, "usage: %s [--ticks N] [--seed N] [--completion-games N] [--batch-steps N]\n", name);
+}
+
+/// Check that the Hamiltonian planner completes every small board that has a cycle.
+/**
+ * One planner plays all games on a board, so it also has to notice when a new game starts.
+ */
+void checkCompletion(Runner & runner, std::uint64_t seed, int games) {
+	std::uint64_t round = 0;
+	for (int width = 2; width <= 8; ++width) {
+		for (int height = 5; height <= 10; ++height) {
+			if (width % 2 != 0 && height % 2 != 0) continue;
+			snake::HamiltonianPlanner hamiltonian({width, height});
+			int cells = width * height;
+			for (int game = 0; game < games; ++game) {
+				context.seed   = snake::mixSeed(seed, round++);
+				context.tick   = 0;
+				context.stream = "hamiltonian completion";
+				runner.start({width, height}, context.seed);
+				while (runner.game.alive && context.tick < std::uint64_t(cells) * cells * 4) runner.step(hamiltonian.plan(runner.game));
+				require(runner.game.won, "the Hamiltonian planner completes the board");
+			}
+		}
+	}
+}
+
+/// Check that BatchEnv plays in lockstep with independent games.
+/**
+ * BatchEnv places fruit differently, so its fruit is copied into the reference games whenever it spawns.
+ * Half the games follow the autopilot to get long games and wins, the other half take random actions.
+ * The observations are compared with the reference boards every 61 steps.
+ */
+void checkBatch(std::uint64_t seed, int steps) {
+	static snake::Vector2 const board_sizes[] = {{4, 5}, {6, 6}, {8, 8}, {12, 9}, {20, 20}};
+	int const count = 16;
+	snake::Autopilot autopilot;
+	snake::Pcg32 choices(seed);
+
+	for (snake::Vector2 const & board_size : board_sizes) {
+		context.seed   = seed;
+		context.tick   = 0;
+		context.stream = "batch lockstep";
+
+		snake::BatchEnv env(count, board_size, seed);
+		std::vector<snake::Game> games(count);
+		std::vector<snake::Pcg32> generators(count);
+		auto syncFruit = [&] (int i) { games[i].fruit = {env.fruitX()[i], env.fruitY()[i]}; };
+		for (int i = 0; i < count; ++i) {
+			games[i].board_size = board_size;
+			games[i].reset(generators[i]);
+			syncFruit(i);
+		}
+
+		int cells = board_size.x * board_size.y;
+		std::vector<snake::Action> actions(count);
+		std::vector<float> rewards(count);
+		std::vector<std::uint8_t> done(count);
+		std::vector<std::uint8_t> observation(std::size_t(count) * snake::BatchEnv::channels * cells);
+
+		for (int step = 0; step < steps; ++step, ++context.tick) {
+			for (int i = 0; i < count; ++i) actions[i] = i % 2 ? snake::Action(choices() % 6) : autopilot.plan(games[i]);
+			env.step(actions.data(), rewards.data(), done.data());
+
+			for (int i = 0; i < count; ++i) {
+				snake::Game & game = games[i];
+				int score = game.score;
+				game.doTick(actions[i], generators[i]);
+				bool ate = game.score > score;
+				require(done[i] == !game.alive, "a batched game ends when its reference game ends");
+				require(rewards[i] == (ate ? 1 : game.alive ? 0 : -1), "a batched game gets the reward of its reference game");
+
+				// Batched games reset automatically at the end of the step.
+				if (!game.alive) game.reset(generators[i]);
+				if (ate || done[i]) syncFruit(i);
+				require(env.alive()[i] == 1, "batched games are reset when they end");
+				require(env.headX()[i] == game.snake.head.x && env.headY()[i] == game.snake.head.y, "a batched snake moves like its reference snake");
+				require(env.lengths()[i] == game.snake.length && env.scores()[i] == game.score, "a batched snake grows like its reference snake");
+			}
+
+			if (step % 61 != 0) continue;
+			env.observe(observation.data());
+			for (int i = 0; i < count; ++i) {
+				snake::Game const & game = games[i];
+				std::uint8_t const * body  = &observation[std::size_t(i) * snake::BatchEnv::channels * cells];
+				std::uint8_t const * head  = body + cells;
+				std::uint8_t const * fruit = head + cells;
+				for (int cell = 0; cell < cells; ++cell) {
+					snake::Vector2 point = {cell % board_size.x, cell / board_size.x};
+					require(body[cell] == game.snake.occupancy.occupied(point), "the batched board matches the reference board");
+					require(head[cell] == (point == game.snake.head), "the batched head is observed in place");
+					require(fruit[cell] == (point == game.fruit), "the batched fruit is observed in place");
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char * * argv) {
+	std::uint64_t total_ticks = 100000000;
+	std::uint64_t seed        = 0;
+	int completion_games      = 20;
+	int batch_steps           = 2000;
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		if (i + 1 >= argc) {
+			printUsage(argv[0]);
+			return 1;
+		}
+		char const * value = argv[++i];
+		if      (option == "--ticks") total_ticks = std::strtoull(value, nullptr, 10);
+		else if (option == "--seed")  seed        = std::strtoull(value, nullptr, 10);
+		else if (option == "--completion-games") completion_games = std::atoi(value);
+		else if (option == "--batch-steps")      batch_steps      = std::atoi(value);
+		else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Small boards, so the snake often fills the board and wins, including the degenerate 1 wide ones.
+	// Boards must be at least 5 high, like in the frontends, or the snake starts partly outside.
+	// The larger square boards are the ones the fixed engine is instantiated for.
+	static snake::Vector2 const board_sizes[] = {{1, 5}, {2, 5}, {3, 6}, {4, 5}, {5, 7}, {6, 6}, {8, 8}, {8, 8}, {12, 9}, {16, 16}, {20, 20}, {32, 32}, {64, 64}};
+	static char const * const streams[] = {"random", "about-turn", "spiral", "reset spam", "autopilot", "hamiltonian"};
+
+	Runner runner;
+	snake::Autopilot autopilot;
+	snake::Pcg32 choices(seed);
+	auto start = std::chrono::steady_clock::now();
+
+	checkCompletion(runner, ~seed, completion_games);
+	checkBatch(seed, batch_steps);
+
+	// Play games of one stream at a time, switching streams and board sizes between games.
+	for (std::uint64_t round = 0; runner.ticks < total_ticks; ++round) {
+		snake::Vector2 board_size = board_sizes[choices() % (sizeof(board_sizes) / sizeof(board_sizes[0]))];
+		int stream = choices() % (sizeof(streams) / sizeof(streams[0]));
+		if (stream == 5 && board_size.x % 2 != 0 && board_size.y % 2 != 0) stream = 4;
+
+		// The planners play long games, and the autopilot costs far more than a tick, so they only get the small boards.
+		if (stream >= 4 && board_size.x * board_size.y > 64) stream = 0;
+
+		context.seed   = snake::mixSeed(seed, round);
+		context.tick   = 0;
+		context.stream = streams[stream];
+		runner.start(board_size, context.seed);
+
+		std::unique_ptr<snake::HamiltonianPlanner> hamiltonian;
+		if (stream == 5) hamiltonian.reset(new snake::HamiltonianPlanner(board_size));
+
+		// Keep going for a while after the game ends, to exercise ticks of dead games and resets.
+		int after_end = 0;
+		while (after_end < 8 && context.tick < 100000) {
+			snake::Action action = snake::Action::none;
+			std::uint32_t value  = choices();
+			switch (stream) {
+				case 0: action = snake::Action(value % 6); break;
+				case 1: action = value % 2 ? snake::directionAction(-runner.game.snake.segments.front().direction) : snake::Action(1 + value / 2 % 4); break;
+				case 2: action = snake::Action(1 + (context.tick / (1 + value % 3)) % 4); break;
+				case 3: action = value % 4 == 0 ? snake::Action::reset : snake::Action(value % 5); break;
+				case 4: action = runner.game.alive ? autopilot.plan(runner.game) : snake::Action::none; break;
+				case 5: action = runner.game.alive ? hamiltonian->plan(runner.game) : snake::Action::none; break;
+			}
+			if (!runner.game.alive) {
+				++after_end;
+				if (after_end == 8) action = snake::Action::reset;
+			}
+			runner.step(action);
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("ticks:        %llu\n", (unsigned long long) runner.ticks);
+	std::printf("games:        %llu\n", (unsigned long long) runner.games);
+	std::printf("wins:         %llu\n", (unsigned long long) runner.wins);
+	std::printf("ticks/second: %.0f\n", runner.ticks / seconds);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.hpp"
+
+namespace snake {
+	Action directionAction(Direction direction) {
+		switch (direction) {
+			case Direction::up:    return Action::up;
+			case Direction::down:  return Action::down;
+			case Direction::left:  return Action::left;
+			case Direction::right: return Action::right;
+		}
+		return Action::none;
+	}
+
+	Direction steerDirection(Direction current, Action action) {
+		// Set the new direction of the snake based on the action.
+		Direction new_direction = current;
+		switch (action) {
+			case Action::up:    new_direction = Direction::up;    break;
+			case Action::right: new_direction = Direction::right; break;
+			case Action::down:  new_direction = Direction::down;  break;
+			case Action::left:  new_direction = Direction::left;  break;
+			default: break;
+		}
+
+		// Dissalow about-turning the snake.
+		if (new_direction == -current) new_direction = current;
+		return new_direction;
+	}
+}
@@ -0,0 +1,228 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "geometry.hpp"
+#include "random.hpp"
+#include "snake.hpp"
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace snake {
+	/// An action a player can take in a game tick.
+	enum class Action {
+		none,
+		up,
+		down,
+		left,
+		right,
+		reset,
+	};
+
+	/// What killed a snake.
+	enum class DeathCause : unsigned char {
+		none,
+		wall,
+		self,
+	};
+
+	/// The messages shown when a game ends.
+	constexpr char const * dead_message = "You are dead. Press [Enter] to reset.";
+	constexpr char const * win_message  = "You win! Press [Enter] to reset.";
+
+	/// Get the action that steers the snake in a direction.
+	Action directionAction(Direction direction);
+
+	/// Get the direction a snake moving in a direction takes when an action is applied.
+	/**
+	 * Actions that do not steer and attempts to about-turn keep the current direction.
+	 */
+	Direction steerDirection(Direction current, Action action);
+
+	/// The rules of a snake game, for any storage policy of the board.
+	/**
+	 * The storage policy decides where the board lives and whether its size is known at compile time,
+	 * see DynamicStorage and FixedStorage. Game and FixedGame are the two instantiations,
+	 * so with the same generator and actions, both see the same fruit, score and ticks.
+	 *
+	 * The random parts of the game take any UniformRandomBitGenerator,
+	 * so callers choose between the small DefaultGenerator and std::mt19937.
+	 */
+	template<typename Storage>
+	struct BasicGame {
+		typename Storage::Size board_size;
+		bool alive = true;
+		bool won = false;
+		DeathCause death_cause = DeathCause::none;
+		int score = 0;
+		BasicSnake<Storage> snake;
+		Vector2 fruit;
+
+		/// Reset a game.
+		template<typename Generator>
+		void reset(Generator & generator) {
+			alive       = true;
+			won         = false;
+			score       = 0;
+			death_cause = DeathCause::none;
+
+			Vector2 size = board_size;
+			snake.reset(size, {size.x / 2, size.y / 2}, Segment{Direction::up, 3});
+			spawnFruit(generator);
+		}
+
+		/// Spawn new fruit on a random free cell of the board.
+		/**
+		 * Returns false if there are no free cells left.
+		 */
+		template<typename Generator>
+		bool spawnFruit(Generator & generator) {
+			int free = snake.occupancy.freeCount();
+			if (free == 0) return false;
+			std::uniform_int_distribution<int> random(0, free - 1);
+			fruit = snake.occupancy.freeCell(random(generator));
+			return true;
+		}
+
+		/// Get the direction the snake will move in when an action is applied in the next tick.
+		/**
+		 * Actions that do not steer and attempts to about-turn keep the current direction.
+		 */
+		Direction nextDirection(Action action) const {
+			return steerDirection(snake.segments.front().direction, action);
+		}
+
+		/// Process a game tick.
+		template<typename Generator>
+		void doTick(Action action, Generator & generator) {
+			// If dead, only a reset action will reset the game.
+			if (!alive) {
+				if (action == Action::reset) reset(generator);
+				return;
+			}
+
+			if (moveSnake(action) && !spawnFruit(generator)) {
+				alive = false;
+				won   = true;
+			}
+		}
+
+	private:
+		/// Move the snake for a tick. Returns true if the snake ate the fruit and new fruit is needed.
+		bool moveSnake(Action action) {
+			Direction new_direction = nextDirection(action);
+
+			// Check the new head position before touching the snake, so a collision leaves the snake as it was.
+			// The tail moves out of the way this tick, unless the snake eats the fruit and grows.
+			Vector2 new_head = snake.head + directionVector(new_direction);
+			bool eating      = new_head == fruit;
+			bool vacated     = new_head == snake.tail && !eating;
+			bool wall = !pointInsideArea(new_head, board_size);
+			if (wall || (snake.occupancy.occupied(new_head) && !vacated)) {
+				alive       = false;
+				death_cause = wall ? DeathCause::wall : DeathCause::self;
+				return false;
+			}
+
+			// Move the snake head (effectively grows the snake by 1).
+			snake.moveHead(new_direction);
+
+			// Check if we hit the fruit this turn, if not shrink the snake.
+			if (eating) {
+				score += 1;
+				return true;
+			}
+
+			snake.shrinkTail();
+			return false;
+		}
+	};
+
+	/// A snake game on a board with a size chosen at run time.
+	/**
+	 * Next to the rules, the game keeps a message for the frontends and can be saved and restored.
+	 */
+	struct Game : BasicGame<DynamicStorage> {
+		std::string message;
+
+		/// Reset a game.
+		template<typename Generator>
+		void reset(Generator & generator) {
+			BasicGame::reset(generator);
+			message = "";
+		}
+
+		/// Process a game tick, updating the message when the game ends or is reset.
+		template<typename Generator>
+		void doTick(Action action, Generator & generator) {
+			bool was_alive = alive;
+			BasicGame::doTick(action, generator);
+			if (alive != was_alive) message = alive ? "" : won ? win_message : dead_message;
+		}
+
+		/// Append the state of the game and of a generator to a flat, versioned binary blob.
+		/**
+		 * The layout is described in game_state.hpp. The blob holds no pointers,
+		 * so it can be copied with memcpy, written to a file and read back from a memory mapping.
+		 */
+		template<typename Generator>
+		void serialize(std::vector<unsigned char> & out, Generator const & generator) const {
+			std::size_t start = out.size();
+			serializeState(out, generatorKind(generator));
+			saveGeneratorState(out, generator);
+			finishState(out, start);
+		}
+
+		/// Restore the state of the game and of a generator from a blob written by serialize().
+		/**
+		 * The blob is decoded into a per-thread staging game which then swaps buffers with this game,
+		 * so restoring games of the same size over and over does not allocate.
+		 * Throws std::runtime_error if the blob is invalid or was written with a different kind of generator.
+		 * Everything is checked before anything is changed, so the game and the generator are left as they were if it throws.
+		 */
+		template<typename Generator>
+		void deserialize(unsigned char const * data, std::size_t size, Generator & generator) {
+			std::size_t generator_size;
+			std::size_t offset = prepareState(data, size, generatorKind(generator), generator_size);
+			Generator restored = generator;
+			loadGeneratorState(data + offset, generator_size, restored);
+			commitState();
+			generator = restored;
+		}
+
+	private:
+		/// Append everything but the generator state to a blob.
+		void serializeState(std::vector<unsigned char> & out, GeneratorKind generator) const;
+
+		/// Fill in the size of the generator state, after it was appended to a blob started at an offset.
+		static void finishState(std::vector<unsigned char> & out, std::size_t start);
+
+		/// Decode everything but the generator state into the staging game of the thread, without touching this game.
+		/**
+		 * Returns the offset and size of the generator state in the blob. Throws std::runtime_error on invalid data.
+		 */
+		static std::size_t prepareState(unsigned char const * data, std::size_t size, GeneratorKind generator, std::size_t & generator_size);
+
+		/// Swap the state decoded by the last prepareState() of the thread into this game.
+		void commitState();
+	};
+}
@@ -0,0 +1,169 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_state.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace snake {
+	namespace {
+		void writeWord(unsigned char * data, std::uint32_t value) {
+			for (int i = 0; i < 4; ++i) data[i] = value >> (8 * i);
+		}
+
+		std::uint32_t readWord(unsigned char const * data) {
+			return std::uint32_t(data[0]) | std::uint32_t(data[1]) << 8 | std::uint32_t(data[2]) << 16 | std::uint32_t(data[3]) << 24;
+		}
+
+		/// The game saved games are decoded into before they replace the state of the target.
+		Game & stagingGame() {
+			thread_local Game staging;
+			return staging;
+		}
+	}
+
+	GameStateView::GameStateView(unsigned char const * data, std::size_t size) : data_(data), size_(size) {
+		if (size < game_state_format::header_size || std::memcmp(data, game_state_format::magic, 4) != 0) {
+			throw std::runtime_error("Not a saved game.");
+		}
+		if (data[4] != game_state_format::version) throw std::runtime_error("Unsupported saved game version.");
+		if (data[5] > static_cast<unsigned char>(GeneratorKind::pcg32)) throw std::runtime_error("Unknown generator in saved game.");
+		if (data[7] > static_cast<unsigned char>(DeathCause::self)) throw std::runtime_error("Unknown death cause in saved game.");
+
+		std::size_t available = size - game_state_format::header_size;
+		if (segmentCount() > available / 4 || freeCount() > available / 4 - segmentCount() || generatorSize() > available - (segmentCount() + freeCount()) * 4) {
+			throw std::runtime_error("Unexpected end of saved game.");
+		}
+	}
+
+	std::uint32_t GameStateView::word(std::size_t offset) const {
+		return readWord(data_ + offset);
+	}
+
+	void Game::serializeState(std::vector<unsigned char> & out, GeneratorKind generator) const {
+		std::size_t start = out.size();
+		out.resize(start + game_state_format::header_size + (snake.segments.size() + snake.occupancy.freeCount()) * 4);
+		unsigned char * data = &out[start];
+
+		std::memcpy(data, game_state_format::magic, 4);
+		data[4] = game_state_format::version;
+		data[5] = static_cast<unsigned char>(generator);
+		data[6] = (alive ? game_state_format::alive : 0) | (won ? game_state_format::won : 0);
+		data[7] = static_cast<unsigned char>(death_cause);
+
+		writeWord(data +  8, board_size.x);
+		writeWord(data + 12, board_size.y);
+		writeWord(data + 16, score);
+		writeWord(data + 20, snake.head.x);
+		writeWord(data + 24, snake.head.y);
+		writeWord(data + 28, fruit.x);
+		writeWord(data + 32, fruit.y);
+		writeWord(data + 36, snake.segments.size());
+		writeWord(data + 40, snake.occupancy.freeCount());
+		writeWord(data + 44, 0);
+
+		data += game_state_format::header_size;
+		for (std::size_t i = 0; i < snake.segments.size(); ++i, data += 4) {
+			Segment const & segment = snake.segments[i];
+			writeWord(data, std::uint32_t(segment.length) << 2 | std::uint32_t(segment.direction));
+		}
+		for (int i = 0; i < snake.occupancy.freeCount(); ++i, data += 4) writeWord(data, snake.occupancy.freeIndex(i));
+	}
+
+	void Game::finishState(std::vector<unsigned char> & out, std::size_t start) {
+		GameStateView view(&out[start], out.size() - start);
+		writeWord(&out[start + 44], out.size() - start - view.generatorOffset());
+	}
+
+	std::size_t Game::prepareState(unsigned char const * data, std::size_t size, GeneratorKind generator, std::size_t & generator_size) {
+		GameStateView view(data, size);
+		if (view.generator() != generator) throw std::runtime_error("Saved game uses a different generator.");
+
+		Vector2 size_of_board = view.boardSize();
+		if (size_of_board.x < 1 || size_of_board.y < 1 || std::int64_t(size_of_board.x) * size_of_board.y > (std::int64_t(1) << 30)) {
+			throw std::runtime_error("Invalid board size in saved game.");
+		}
+		if (!pointInsideArea(view.head(), size_of_board) || !pointInsideArea(view.fruit(), size_of_board)) {
+			throw std::runtime_error("Point outside of the board in saved game.");
+		}
+		if (view.segmentCount() == 0) throw std::runtime_error("Saved game has no snake.");
+
+		// Rebuild the snake and its occupancy grid by walking the segments from the head.
+		Snake & snake = stagingGame().snake;
+		snake.head   = view.head();
+		snake.length = 0;
+		snake.segments.clear();
+		snake.occupancy.beginRestore(size_of_board);
+
+		std::int64_t cells = std::int64_t(size_of_board.x) * size_of_board.y;
+		Vector2 point = snake.head;
+		for (std::size_t i = 0; i < view.segmentCount(); ++i) {
+			Segment segment = view.segment(i);
+			if (segment.length < 1 || snake.length + std::int64_t(segment.length) > cells) {
+				throw std::runtime_error("Invalid segment in saved game.");
+			}
+			snake.segments.push_back(segment);
+			snake.length += segment.length;
+
+			for (int j = 0; j < segment.length; ++j) {
+				if (!pointInsideArea(point, size_of_board)) throw std::runtime_error("Snake outside of the board in saved game.");
+				if (!snake.occupancy.addRestored(point)) throw std::runtime_error("Snake overlaps itself in saved game.");
+				snake.tail = point;
+				point -= directionVector(segment.direction);
+			}
+		}
+
+		// The snake covers exactly length cells, so with that many free cells listed once each, the free set is complete.
+		unsigned char const * free = data + game_state_format::header_size + view.segmentCount() * 4;
+		if (snake.length + std::int64_t(view.freeCount()) != cells || !snake.occupancy.finishRestore(view.freeCount(), [free] (std::size_t i) { return readWord(free + 4 * i); })) {
+			throw std::runtime_error("Invalid free cells in saved game.");
+		}
+
+		// The fruit is only left on the snake when it was eaten filling the board.
+		if (snake.occupancy.occupied(view.fruit()) && view.freeCount() != 0) {
+			throw std::runtime_error("Fruit on the snake in saved game.");
+		}
+
+		// The snake is valid, so the rest of the header can be taken as is.
+		Game & staging = stagingGame();
+		staging.board_size  = size_of_board;
+		staging.alive       = view.alive();
+		staging.won         = view.won();
+		staging.death_cause = view.deathCause();
+		staging.score       = view.score();
+		staging.fruit       = view.fruit();
+
+		generator_size = view.generatorSize();
+		return view.generatorOffset();
+	}
+
+	void Game::commitState() {
+		// Swap rather than copy, so the staging game keeps buffers to decode the next saved game into.
+		Game & staging = stagingGame();
+		std::swap(snake, staging.snake);
+		board_size  = staging.board_size;
+		alive       = staging.alive;
+		won         = staging.won;
+		death_cause = staging.death_cause;
+		score       = staging.score;
+		fruit       = staging.fruit;
+		message     = won ? win_message : alive ? "" : dead_message;
+	}
+}
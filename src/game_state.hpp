@@ -0,0 +1,104 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+#include "random.hpp"
+#include "snake.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace snake {
+	/// Games are saved as a flat binary blob without any pointers.
+	/**
+	 * All fields are little endian. The blob starts with a fixed size header:
+	 *  - offset  0: the magic bytes "NSGS",
+	 *  - offset  4: the format version as one byte,
+	 *  - offset  5: the GeneratorKind of the saved generator as one byte,
+	 *  - offset  6: flags as one byte, 0x1 if the snake is alive and 0x2 if the game was won,
+	 *  - offset  7: the DeathCause as one byte, which used to be a reserved zero byte,
+	 *  - offset  8: the board width and height, the score, the head x and y and the fruit x and y as 32 bit integers,
+	 *  - offset 36: the number of segments as a 32 bit integer,
+	 *  - offset 40: the number of free cells as a 32 bit integer,
+	 *  - offset 44: the size of the generator state in bytes as a 32 bit integer.
+	 *
+	 * Then follow the segments from the head to the tail, as 32 bit integers holding (length << 2) | direction,
+	 * the free cells of the occupancy grid as 32 bit cell indices (y * width + x) in the order of the free set,
+	 * and finally the generator state as written by saveGeneratorState().
+	 *
+	 * The order of the free set decides where the next fruit spawns, so it is needed to continue the game exactly as the original.
+	 * It also makes the blob size proportional to the board size, like the occupancy grid itself.
+	 * The message of the game is not saved, it follows from the flags.
+	 */
+	namespace game_state_format {
+		constexpr char magic[4] = {'N', 'S', 'G', 'S'};
+		constexpr unsigned char version = 1;
+		constexpr std::size_t header_size = 48;
+
+		constexpr unsigned char alive = 0x1;
+		constexpr unsigned char won   = 0x2;
+	}
+
+	/// Read-only view of a saved game that reads straight from the blob, for example from a memory mapped file.
+	/**
+	 * The header is validated on construction, the segments are only decoded when asked for.
+	 */
+	class GameStateView {
+		unsigned char const * data_;
+		std::size_t size_;
+
+		std::uint32_t word(std::size_t offset) const;
+
+	public:
+		/// Create a view of a blob. Throws std::runtime_error if the header is invalid or the blob is too short.
+		GameStateView(unsigned char const * data, std::size_t size);
+
+		/// Get the total size of the saved game, which may be less than the size of the buffer it is in.
+		std::size_t size() const { return game_state_format::header_size + (segmentCount() + freeCount()) * 4 + generatorSize(); }
+
+		GeneratorKind generator() const { return GeneratorKind(data_[5]); }
+		bool alive() const { return data_[6] & game_state_format::alive; }
+		bool won() const { return data_[6] & game_state_format::won; }
+		DeathCause deathCause() const { return DeathCause(data_[7]); }
+		Vector2 boardSize() const { return {int(word(8)), int(word(12))}; }
+		int score() const { return word(16); }
+		Vector2 head() const { return {int(word(20)), int(word(24))}; }
+		Vector2 fruit() const { return {int(word(28)), int(word(32))}; }
+		std::size_t segmentCount() const { return word(36); }
+		std::size_t freeCount() const { return word(40); }
+		std::size_t generatorSize() const { return word(44); }
+
+		/// Get a segment, counting from the head.
+		Segment segment(std::size_t i) const {
+			std::uint32_t value = word(game_state_format::header_size + 4 * i);
+			return {Direction(value & 3), int(value >> 2)};
+		}
+
+		/// Get the cell index of a free cell, in the order of the free set.
+		std::uint32_t freeIndex(std::size_t i) const { return word(game_state_format::header_size + 4 * (segmentCount() + i)); }
+
+		/// Get the saved generator state.
+		unsigned char const * generatorState() const { return data_ + generatorOffset(); }
+
+		/// Get the offset of the generator state in the blob.
+		std::size_t generatorOffset() const { return game_state_format::header_size + (segmentCount() + freeCount()) * 4; }
+	};
+}
@@ -0,0 +1,97 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace snake {
+	/// A point in a 2D space.
+	struct Vector2 {
+		int x;
+		int y;
+	};
+
+	inline bool operator==(Vector2 const & a, Vector2 const & b) { return a.x == b.x && a.y == b.y; }
+	inline bool operator!=(Vector2 const & a, Vector2 const & b) { return !(a == b); }
+
+	constexpr Vector2 operator*(Vector2 const & a, int scalar) { return {a.x * scalar, a.y * scalar}; };
+	constexpr Vector2 operator*(int scalar, Vector2 const & a) { return a * scalar; }
+	inline Vector2 & operator*=(Vector2 & a, int scalar) { return a = a * scalar; }
+
+	constexpr Vector2 operator-(Vector2 const & a) { return a * -1; }
+	constexpr Vector2 operator+(Vector2 const & a) { return a; }
+
+	constexpr Vector2 operator+(Vector2 const & a, Vector2 const & b) { return {a.x + b.x, a.y + b.y}; };
+	constexpr Vector2 operator-(Vector2 const & a, Vector2 const & b) { return a + -b; };
+	inline Vector2 & operator+=(Vector2 & a, Vector2 const & b) { return a = a + b; };
+	inline Vector2 & operator-=(Vector2 & a, Vector2 const & b) { return a = a - b; };
+
+	/// A direction on the board.
+	/**
+	 * The values are used as indices in lookup tables,
+	 * and opposite directions differ only in the lowest bit.
+	 */
+	enum class Direction {
+		up,
+		down,
+		left,
+		right
+	};
+
+	/// The unit vectors of all directions, indexed by direction.
+	constexpr Vector2 direction_vectors[] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+	/// Get the opposite of a direction.
+	constexpr Direction operator-(Direction direction) { return Direction(int(direction) ^ 1); }
+
+	/// Get the unit vector for a direction.
+	constexpr Vector2 directionVector(Direction direction) { return direction_vectors[int(direction) & 3]; }
+
+	/// A segment of a snake.
+	struct Segment {
+		Direction direction;
+		int length;
+	};
+
+	/// A line in 2D space.
+	struct Line {
+		Vector2 start;
+		Direction direction;
+		int length;
+
+		Line(Vector2 const & start, Direction const & direction, int length) : start(start), direction(direction), length(length) {};
+		Line(Vector2 const & start, Segment const & segment) : Line(start, segment.direction, segment.length) {};
+	};
+
+	/// Check if a point is on a given line.
+	/**
+	 * The offset from the start is projected on the direction of the line and on its normal,
+	 * so there is no branch on the direction.
+	 */
+	inline bool pointOnLine(Vector2 const & point, Line const & line) {
+		Vector2 diff   = point - line.start;
+		Vector2 vector = directionVector(line.direction);
+		int along      = diff.x * vector.x + diff.y * vector.y;
+		int across     = diff.x * vector.y - diff.y * vector.x;
+		return across == 0 && along >= 0 && along < line.length;
+	}
+
+	/// Check if a point is inside a given area.
+	inline bool pointInsideArea(Vector2 const & point, Vector2 const & area) {
+		return point.x >= 0 && point.x < area.x && point.y >= 0 && point.y < area.y;
+	}
+}
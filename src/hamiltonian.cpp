@@ -0,0 +1,191 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hamiltonian.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace snake {
+	namespace {
+		Direction const directions[4] = {Direction::up, Direction::down, Direction::left, Direction::right};
+
+		/// Get the direction of the cycle at a point on a board with an even height.
+		Direction rowCycleDirection(Vector2 const & size, Vector2 const & point) {
+			if (point.x == 0) return point.y == 0 ? Direction::right : Direction::up;
+			if (point.y % 2 == 0) return point.x == size.x - 1 ? Direction::down : Direction::right;
+			if (point.y == size.y - 1 || point.x > 1) return Direction::left;
+			return Direction::down;
+		}
+
+		/// Check if two points are neighbours.
+		bool adjacent(Vector2 const & a, Vector2 const & b) {
+			return std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1;
+		}
+
+		/// Swap the axes of a direction.
+		Direction transpose(Direction direction) {
+			switch (direction) {
+				case Direction::up:    return Direction::left;
+				case Direction::down:  return Direction::right;
+				case Direction::left:  return Direction::up;
+				case Direction::right: return Direction::down;
+			}
+			return direction;
+		}
+	}
+
+	HamiltonianCycle::HamiltonianCycle(Vector2 const & size, bool reversed) : size_(size) {
+		if (size.x < 2 || size.y < 2 || (size.x % 2 != 0 && size.y % 2 != 0)) {
+			throw std::invalid_argument("Board has no Hamiltonian cycle, one dimension must be even.");
+		}
+
+		bool transposed = size.y % 2 != 0;
+		int cells = size.x * size.y;
+		order_.assign(cells, -1);
+		next_.assign(cells, Direction::up);
+
+		Vector2 point = {0, 0};
+		for (int i = 0; i < cells; ++i) {
+			Direction direction;
+			if (transposed) {
+				direction = transpose(rowCycleDirection({size.y, size.x}, {point.y, point.x}));
+			} else {
+				direction = rowCycleDirection(size, point);
+			}
+			order_[point.y * size.x + point.x] = i;
+			next_[point.y * size.x + point.x]  = direction;
+			point += directionVector(direction);
+		}
+
+		// Running the cycle in reverse, every cell leads back to the cell before it.
+		if (reversed) {
+			std::vector<Direction> forward = next_;
+			for (int i = 0; i < cells; ++i) {
+				Vector2 from = {i % size.x, i / size.x};
+				Vector2 to   = from + directionVector(forward[i]);
+				next_[to.y * size.x + to.x] = -forward[i];
+				order_[i] = (cells - order_[i]) % cells;
+			}
+		}
+	}
+
+	bool HamiltonianCycle::follows(SnakeBody const & body) const {
+		// Walking from the head to the tail, every cell has to come before the previous one on the cycle.
+		// The steps back add up to the distance from the tail to the head exactly when no step passes the tail.
+		std::int64_t total = 0;
+		Vector2 point = body.head;
+		for (std::size_t i = 0; i < body.segments.size(); ++i) {
+			Segment const & segment = body.segments[i];
+			Vector2 step = directionVector(segment.direction);
+			for (int j = 0; j < segment.length; ++j) {
+				Vector2 behind = point - step;
+				total += distance(behind, point);
+				point = behind;
+			}
+		}
+		return total == distance(point, body.head);
+	}
+
+	std::shared_ptr<HamiltonianCycle const> HamiltonianCycle::get(Vector2 const & size, bool reversed) {
+		static std::mutex mutex;
+		static std::map<std::pair<std::pair<int, int>, bool>, std::shared_ptr<HamiltonianCycle const>> cache;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto & cycle = cache[std::make_pair(std::make_pair(size.x, size.y), reversed)];
+		if (!cycle) cycle = std::make_shared<HamiltonianCycle const>(size, reversed);
+		return cycle;
+	}
+
+	HamiltonianPlanner::HamiltonianPlanner(Vector2 const & board_size) :
+		forward_(HamiltonianCycle::get(board_size)),
+		reverse_(HamiltonianCycle::get(board_size, true)) {}
+
+	Action HamiltonianPlanner::plan(Game const & game) {
+		if (!game.alive) return Action::none;
+
+		Snake const & snake  = game.snake;
+		Vector2 const & head = snake.head;
+		Direction current    = snake.segments.front().direction;
+
+		// Recognize the game planned for on the previous tick: the head moved one cell on from there,
+		// and the tail stayed put or moved one cell on.
+		// Any other game is checked from scratch, and so is a body that is not in cycle order yet.
+		Vector2 neck = head - directionVector(current);
+		bool continued = ordered_
+			&& neck == last_head_
+			&& (snake.length == last_length_ || snake.length == last_length_ + 1)
+			&& (snake.tail == last_tail_ || adjacent(snake.tail, last_tail_));
+
+		// Pick the direction to run the cycle in. Once the body is in order with one, it stays in order with that one.
+		// A body out of order with both follows the forward cycle until it is in order with either.
+		if (!continued) {
+			ordered_  = forward_->follows(snake);
+			reversed_ = !ordered_ && reverse_->follows(snake);
+			ordered_  = ordered_ || reversed_;
+		}
+		HamiltonianCycle const & cycle = reversed_ ? *reverse_ : *forward_;
+
+		int to_tail  = cycle.distance(head, snake.tail);
+		int to_fruit = cycle.distance(head, game.fruit);
+		int free     = snake.occupancy.freeCount();
+
+		// Keep a few cells of slack before the tail, and more when the fruit is close to the tail,
+		// since the tail stops for a tick when the snake grows.
+		// Shortcuts are only safe once the body is in cycle order.
+		int available = to_tail - 4;
+		if (to_fruit < to_tail && (to_tail - to_fruit) * 4 > free) available -= 10;
+		if (snake.length * 2 > cycle.length() || !ordered_) available = 0;
+		if (available > to_fruit) available = to_fruit;
+
+		// Take the neighbour that skips furthest ahead on the cycle within the available slack.
+		// Following the cycle itself is a skip of one, which is always allowed.
+		// If no neighbour qualifies (the body blocks the cycle at the start of a game),
+		// settle for the free neighbour with the smallest skip.
+		int best_skip     = 0;
+		int fallback_skip = 0;
+		Direction best     = cycle.next(head);
+		Direction fallback = best;
+		for (Direction direction : directions) {
+			if (direction == -current) continue;
+			Vector2 next = head + directionVector(direction);
+			if (!pointInsideArea(next, game.board_size)) continue;
+			if (snake.occupancy.occupied(next) && next != snake.tail) continue;
+
+			int skip = cycle.distance(head, next);
+			if ((skip == 1 || skip <= available) && skip > best_skip) {
+				best_skip = skip;
+				best      = direction;
+			}
+			if (fallback_skip == 0 || skip < fallback_skip) {
+				fallback_skip = skip;
+				fallback      = direction;
+			}
+		}
+
+		// Moves within the free stretch ahead of the head keep the body in cycle order, other moves may not.
+		ordered_     = ordered_ && best_skip > 0;
+		last_head_   = head;
+		last_tail_   = snake.tail;
+		last_length_ = snake.length;
+		return directionAction(best_skip > 0 ? best : fallback);
+	}
+}
@@ -0,0 +1,123 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace snake {
+	/// A Hamiltonian cycle visiting every cell of a board exactly once.
+	/**
+	 * The cycle sweeps back and forth over all rows but one column, and returns through that column.
+	 * Boards with an odd height use the transposed cycle, so a cycle exists if either dimension is even.
+	 * The same cycle can also be run in reverse.
+	 */
+	class HamiltonianCycle {
+		Vector2 size_;
+
+		/// The position of every cell on the cycle.
+		std::vector<int> order_;
+
+		/// The direction from every cell to the next cell on the cycle.
+		std::vector<Direction> next_;
+
+	public:
+		/// Compute the cycle for a board, optionally in reverse. Throws std::invalid_argument if the board has no cycle.
+		explicit HamiltonianCycle(Vector2 const & size, bool reversed = false);
+
+		/// Get the shared cycle for a board size, computing it on first use.
+		/**
+		 * Cycles are cached per board size for the lifetime of the program and never change,
+		 * so they can be used from multiple threads without synchronization.
+		 * Throws std::invalid_argument if the board has no cycle.
+		 */
+		static std::shared_ptr<HamiltonianCycle const> get(Vector2 const & size, bool reversed = false);
+
+		/// Get the board size of the cycle.
+		Vector2 const & size() const { return size_; }
+
+		/// Get the number of cells on the cycle.
+		int length() const { return order_.size(); }
+
+		/// Get the position of a point on the cycle.
+		int order(Vector2 const & point) const { return order_[point.y * size_.x + point.x]; }
+
+		/// Get the direction from a point to the next point on the cycle.
+		Direction next(Vector2 const & point) const { return next_[point.y * size_.x + point.x]; }
+
+		/// Get the number of steps along the cycle from one point to another.
+		int distance(Vector2 const & from, Vector2 const & to) const {
+			int distance = order(to) - order(from);
+			return distance < 0 ? distance + length() : distance;
+		}
+
+		/// Check if a snake lies in cycle order, with every cell from the tail to the head further along the cycle.
+		/**
+		 * The cells need not be consecutive on the cycle, shortcuts leave gaps.
+		 * This takes time proportional to the length of the snake.
+		 */
+		bool follows(SnakeBody const & body) const;
+	};
+
+	/// Plans moves along a Hamiltonian cycle, taking safe shortcuts towards the fruit.
+	/**
+	 * Following the cycle alone always completes the board.
+	 * As long as the body lies in cycle order between the tail and the head,
+	 * the cells ahead of the head up to the tail are free, so the head may jump ahead on the cycle
+	 * to any neighbour in that stretch without ever trapping itself.
+	 * Shortcuts leave some slack before the tail, never overshoot the fruit,
+	 * and are disabled once the snake covers half the board.
+	 *
+	 * A new game starts with a snake that is not on the cycle, so until the whole body is in cycle order
+	 * the planner follows the cycle strictly, and only steps off it where the body blocks the cycle.
+	 * The cycle runs forward, unless the body is in order with the reversed cycle.
+	 * That matters on narrow boards, where a snake that starts against the cycle can never get in order with it.
+	 * Taking shortcuts keeps the body in cycle order, so from then on it stays there.
+	 *
+	 * The planner remembers the state it planned for, so while it plays one game in order it takes constant time per tick.
+	 * Checking the order of a body from scratch takes time proportional to its length,
+	 * which happens at the start of a game, while the body is out of order, and when switching games.
+	 */
+	class HamiltonianPlanner {
+		std::shared_ptr<HamiltonianCycle const> forward_;
+		std::shared_ptr<HamiltonianCycle const> reverse_;
+
+		/// The snake planned for on the previous call.
+		Vector2 last_head_ = {-1, -1};
+		Vector2 last_tail_ = {-1, -1};
+		int last_length_   = 0;
+
+		/// True if the body was in order with the chosen cycle after the previous move.
+		bool ordered_  = false;
+
+		/// True if the chosen cycle is the reversed one.
+		bool reversed_ = false;
+
+	public:
+		/// Create a planner for a board size. Throws std::invalid_argument if the board has no cycle.
+		explicit HamiltonianPlanner(Vector2 const & board_size);
+
+		/// Pick the action for the next tick of a game.
+		Action plan(Game const & game);
+	};
+}
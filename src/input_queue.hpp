@@ -0,0 +1,73 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+
+#include <cstddef>
+
+namespace snake {
+	/// A small bounded queue of actions waiting for the next game ticks.
+	/**
+	 * Input is drained from the terminal as soon as it arrives, but a game tick only applies one action.
+	 * Buffering turns here means quick key sequences (up then left within one tick)
+	 * are applied on consecutive ticks instead of getting lost.
+	 *
+	 * Empty actions and repeats of the last queued action are ignored.
+	 * When the queue is full, new actions are dropped.
+	 */
+	class InputQueue {
+	public:
+		static constexpr std::size_t capacity = 4;
+
+	private:
+		Action actions_[capacity];
+		std::size_t start_ = 0;
+		std::size_t size_  = 0;
+
+	public:
+		/// Get the number of queued actions.
+		std::size_t size() const { return size_; }
+
+		/// Check if the queue is empty.
+		bool empty() const { return size_ == 0; }
+
+		/// Remove all queued actions.
+		void clear() { size_ = 0; }
+
+		/// Queue an action. Returns false if the action was dropped.
+		bool push(Action action) {
+			if (action == Action::none) return false;
+			if (size_ > 0 && actions_[(start_ + size_ - 1) % capacity] == action) return false;
+			if (size_ == capacity) return false;
+			actions_[(start_ + size_) % capacity] = action;
+			++size_;
+			return true;
+		}
+
+		/// Take the next action from the queue, or Action::none if the queue is empty.
+		Action pop() {
+			if (size_ == 0) return Action::none;
+			Action result = actions_[start_];
+			start_ = (start_ + 1) % capacity;
+			--size_;
+			return result;
+		}
+	};
+}
@@ -0,0 +1,123 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace snake {
+	/// Lock-free histogram of durations in nanoseconds with fixed, logarithmic buckets.
+	/**
+	 * Every power of two is split in sub_buckets buckets, so a bucket is at most 1/8th wide relative to its value.
+	 * Any number of threads can record durations while another takes snapshots;
+	 * counters are independent relaxed atomics, so a snapshot is not a single instant but never loses samples.
+	 * Durations longer than about 18 minutes end up in the last bucket.
+	 */
+	class LatencyHistogram {
+	public:
+		static constexpr int sub_bits    = 3;
+		static constexpr int sub_buckets = 1 << sub_bits;
+		static constexpr int max_bits    = 40;
+		static constexpr int bucket_count = (max_bits - sub_bits + 1) * sub_buckets;
+
+		/// The bucket counts of a histogram at some point in time.
+		struct Snapshot {
+			std::array<std::uint64_t, bucket_count> counts{};
+
+			/// Get the total number of samples.
+			std::uint64_t total() const {
+				std::uint64_t result = 0;
+				for (std::uint64_t count : counts) result += count;
+				return result;
+			}
+
+			/// Get the upper bound in nanoseconds of the bucket holding a fraction of the samples, or 0 without samples.
+			/**
+			 * A fraction of 0.5 gives the median, and a fraction of 1 the maximum.
+			 */
+			std::uint64_t quantile(double fraction) const {
+				std::uint64_t samples = total();
+				if (samples == 0) return 0;
+				std::uint64_t rank = fraction * (samples - 1);
+				std::uint64_t seen = 0;
+				for (int i = 0; i < bucket_count; ++i) {
+					seen += counts[i];
+					if (seen > rank) return bucketEnd(i) - 1;
+				}
+				return bucketEnd(bucket_count - 1) - 1;
+			}
+
+			/// Get the samples recorded between an older snapshot and this one.
+			Snapshot operator-(Snapshot const & older) const {
+				Snapshot result;
+				for (int i = 0; i < bucket_count; ++i) result.counts[i] = counts[i] - older.counts[i];
+				return result;
+			}
+		};
+
+		/// Get the bucket of a duration in nanoseconds.
+		static int bucket(std::uint64_t nanoseconds) {
+			if (nanoseconds < sub_buckets) return nanoseconds;
+			int exponent = sub_bits;
+			while (nanoseconds >> (exponent + 1)) ++exponent;
+			if (exponent >= max_bits) return bucket_count - 1;
+			return (exponent - sub_bits + 1) * sub_buckets + ((nanoseconds >> (exponent - sub_bits)) & (sub_buckets - 1));
+		}
+
+		/// Get the first duration in nanoseconds after a bucket.
+		static std::uint64_t bucketEnd(int bucket) {
+			if (bucket < sub_buckets) return bucket + 1;
+			int exponent = bucket / sub_buckets + sub_bits - 1;
+			std::uint64_t sub = bucket % sub_buckets;
+			return (sub_buckets + sub + 1) << (exponent - sub_bits);
+		}
+
+		/// Record a duration in nanoseconds.
+		void record(std::uint64_t nanoseconds) {
+			counts_[bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// Record a duration.
+		void record(std::chrono::steady_clock::duration duration) {
+			std::int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+			record(std::uint64_t(nanoseconds < 0 ? 0 : nanoseconds));
+		}
+
+		/// Take a snapshot of the bucket counts.
+		Snapshot snapshot() const {
+			Snapshot result;
+			for (int i = 0; i < bucket_count; ++i) result.counts[i] = counts_[i].load(std::memory_order_relaxed);
+			return result;
+		}
+
+	private:
+		std::array<std::atomic<std::uint64_t>, bucket_count> counts_{};
+	};
+
+	/// Time a function call and record its duration in a histogram.
+	template<typename F>
+	void timed(LatencyHistogram & histogram, F && function) {
+		auto start = std::chrono::steady_clock::now();
+		function();
+		histogram.record(std::chrono::steady_clock::now() - start);
+	}
+}
@@ -0,0 +1,176 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multi_game.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace snake {
+	constexpr std::uint8_t OwnerGrid::none;
+	constexpr std::uint8_t OwnerGrid::fruit;
+	constexpr int MultiGame::max_players;
+	constexpr int MultiGame::head_table_size;
+
+	void MultiGame::resetPlayers(int player_count) {
+		if (player_count < 1 || player_count > max_players) {
+			throw std::invalid_argument("A multi-snake game needs between 1 and 64 snakes.");
+		}
+
+		grid.reset(board_size);
+		players.resize(player_count);
+		moves_.resize(player_count);
+		head_cells_.assign(head_table_size, HeadCell());
+		head_generation_ = 0;
+		tick = 0;
+
+		// Spread the snakes over a grid of cells, with as many rows of snakes as fit.
+		Segment const start = {Direction::up, 3};
+		int rows    = std::max(1, std::min(player_count, board_size.y / (start.length + 1)));
+		int columns = (player_count + rows - 1) / rows;
+		rows        = (player_count + columns - 1) / columns;
+		int width   = board_size.x / columns;
+		int height  = board_size.y / rows;
+		if (width < 1 || height < start.length) {
+			throw std::invalid_argument("The board is too small for the number of snakes.");
+		}
+
+		for (int i = 0; i < player_count; ++i) {
+			int column = i % columns;
+			int row    = i / columns;
+			Vector2 head = {column * width + width / 2, row * height + (height - start.length) / 2};
+
+			Player & player = players[i];
+			player.SnakeBody::reset(head, start);
+			player.alive   = true;
+			player.score   = 0;
+			player.died_at = 0;
+			for (int j = 0; j < start.length; ++j) grid.set(head + Vector2{0, j}, OwnerGrid::playerOwner(i));
+		}
+	}
+
+	int MultiGame::aliveCount() const {
+		int count = 0;
+		for (Player const & player : players) count += player.alive;
+		return count;
+	}
+
+	bool MultiGame::finished() const {
+		int alive = aliveCount();
+		return players.size() > 1 ? alive <= 1 : alive == 0;
+	}
+
+	Direction MultiGame::nextDirection(int player, Action action) const {
+		return steerDirection(players[player].segments.front().direction, action);
+	}
+
+	MultiGame::HeadCell & MultiGame::headCell(int cell) {
+		// Fibonacci hashing of the cell index into the table.
+		std::uint32_t slot = (std::uint32_t(cell) * 2654435769u) >> 25;
+		while (head_cells_[slot].stamp == head_generation_ && head_cells_[slot].cell != cell) {
+			slot = (slot + 1) % head_table_size;
+		}
+		return head_cells_[slot];
+	}
+
+	void MultiGame::clearBody(Player const & player) {
+		Vector2 point = player.head;
+		for (std::size_t i = 0; i < player.segments.size(); ++i) {
+			Segment const & segment = player.segments[i];
+			for (int j = 0; j < segment.length; ++j) {
+				grid.set(point, OwnerGrid::none);
+				point -= directionVector(segment.direction);
+			}
+		}
+	}
+
+	int MultiGame::moveSnakes(Action const * actions) {
+		int const count = players.size();
+
+		// Work out where every snake goes, and if it runs off the board or into fruit.
+		for (int i = 0; i < count; ++i) {
+			if (!players[i].alive) continue;
+			Move & move    = moves_[i];
+			move.direction = nextDirection(i, actions[i]);
+			move.head      = players[i].head + directionVector(move.direction);
+			move.dies      = !pointInsideArea(move.head, board_size);
+			move.eating    = !move.dies && grid.owner(move.head) == OwnerGrid::fruit;
+		}
+
+		// Tails move out of the way before any body is checked, unless the snake eats and grows.
+		for (int i = 0; i < count; ++i) {
+			if (!players[i].alive || moves_[i].eating) continue;
+			grid.set(players[i].tail, OwnerGrid::none);
+			players[i].shrinkTail();
+		}
+
+		// Heads moving into a body die.
+		for (int i = 0; i < count; ++i) {
+			if (!players[i].alive || moves_[i].dies) continue;
+			if (grid.snakeAt(moves_[i].head)) moves_[i].dies = true;
+		}
+
+		// Heads moving into the same cell: the longest snake survives, a tie kills them all.
+		// After the tails moved every snake is one shorter than it will be at the end of the tick.
+		++head_generation_;
+		for (int i = 0; i < count; ++i) {
+			if (!players[i].alive || moves_[i].dies) continue;
+			int cell = moves_[i].head.y * board_size.x + moves_[i].head.x;
+			HeadCell & entry = headCell(cell);
+			if (entry.stamp != head_generation_) {
+				entry = {cell, i, false, head_generation_};
+			} else if (players[i].length > players[entry.winner].length) {
+				entry.winner = i;
+				entry.tied   = false;
+			} else if (players[i].length == players[entry.winner].length) {
+				entry.tied = true;
+			}
+		}
+		for (int i = 0; i < count; ++i) {
+			if (!players[i].alive || moves_[i].dies) continue;
+			HeadCell const & entry = headCell(moves_[i].head.y * board_size.x + moves_[i].head.x);
+			if (entry.winner != i || entry.tied) moves_[i].dies = true;
+		}
+
+		// Apply the moves of the survivors and clear the bodies of the dead.
+		int eaten = 0;
+		for (int i = 0; i < count; ++i) {
+			Player & player = players[i];
+			Move const & move = moves_[i];
+			if (!player.alive) continue;
+
+			if (move.dies) {
+				clearBody(player);
+				player.alive   = false;
+				player.died_at = tick;
+				continue;
+			}
+
+			if (move.eating) {
+				fruits.erase(std::find(fruits.begin(), fruits.end(), move.head));
+				player.score += 1;
+				eaten        += 1;
+			}
+			player.moveHead(move.direction);
+			grid.set(player.head, OwnerGrid::playerOwner(i));
+		}
+
+		++tick;
+		return eaten;
+	}
+}
@@ -0,0 +1,201 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+#include "snake.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace snake {
+	/// A board shared by many snakes, recording the owner of every cell.
+	/**
+	 * Every cell is free, holds fruit, or belongs to exactly one snake.
+	 * An occupancy grid tracks the same cells, to keep the set of free cells for spawning fruit.
+	 * Points outside of the board read as free and are ignored when set.
+	 */
+	class OwnerGrid {
+	public:
+		static constexpr std::uint8_t none  = 0;
+		static constexpr std::uint8_t fruit = 0xff;
+
+		/// Get the owner ID of the snake with an index.
+		static std::uint8_t playerOwner(int player) { return player + 1; }
+
+	private:
+		Occupancy occupancy_;
+		std::vector<std::uint8_t> owners_;
+
+		int index(Vector2 const & point) const { return point.y * occupancy_.size().x + point.x; }
+
+	public:
+		/// Get the size of the board.
+		Vector2 const & size() const { return occupancy_.size(); }
+
+		/// Resize the board and mark all cells as free.
+		void reset(Vector2 const & size) {
+			occupancy_.reset(size);
+			owners_.assign(size.x * size.y, none);
+		}
+
+		/// Get the owner of a cell.
+		std::uint8_t owner(Vector2 const & point) const {
+			if (!pointInsideArea(point, size())) return none;
+			return owners_[index(point)];
+		}
+
+		/// Check if a cell belongs to a snake.
+		bool snakeAt(Vector2 const & point) const {
+			std::uint8_t value = owner(point);
+			return value != none && value != fruit;
+		}
+
+		/// Set the owner of a cell, or free it by setting the owner to none.
+		void set(Vector2 const & point, std::uint8_t value) {
+			if (!pointInsideArea(point, size())) return;
+			std::uint8_t & cell = owners_[index(point)];
+			if (cell == none && value != none) occupancy_.add(point);
+			if (cell != none && value == none) occupancy_.remove(point);
+			cell = value;
+		}
+
+		/// Get the number of free cells.
+		int freeCount() const { return occupancy_.freeCount(); }
+
+		/// Get a free cell by index in the range [0, freeCount()).
+		Vector2 freeCell(int i) const { return occupancy_.freeCell(i); }
+	};
+
+	/// A snake in a multi-snake game.
+	struct Player : SnakeBody {
+		bool alive = true;
+		int score  = 0;
+
+		/// The tick this snake died in, if it is dead.
+		int died_at = 0;
+	};
+
+	/// A game of many snakes on one board.
+	/**
+	 * All snakes move at the same time, and collisions are resolved after every snake moved:
+	 *  - a snake moving off the board dies,
+	 *  - a snake moving into any body dies, including its own, but tails that move away this tick are free,
+	 *  - when several heads move into the same cell, the longest snake survives and a tie kills all of them.
+	 * A snake that eats grows, so its tail stays in place.
+	 * Bodies of dead snakes are removed from the board at the end of the tick.
+	 *
+	 * Every check is a lookup in the shared owner grid, and heads meeting in one cell are found through
+	 * a small hash table keyed by the target cell, so a tick costs O(snakes) apart from clearing dead bodies.
+	 * Snakes are always processed in index order, so a game is deterministic for a given seed and actions.
+	 */
+	struct MultiGame {
+		static constexpr int max_players = 64;
+
+		Vector2 board_size;
+		std::vector<Player> players;
+		std::vector<Vector2> fruits;
+		OwnerGrid grid;
+		int tick = 0;
+
+		/// Reset the game with a number of snakes and pieces of fruit.
+		/**
+		 * The snakes start as short vertical lines moving up, spread over the board in a grid.
+		 * Throws std::invalid_argument if the number of snakes is out of range or they do not fit on the board.
+		 */
+		template<typename Generator>
+		void reset(int player_count, int fruit_count, Generator & generator) {
+			resetPlayers(player_count);
+			fruits.clear();
+			for (int i = 0; i < fruit_count; ++i) spawnFruit(generator);
+		}
+
+		/// Spawn a new piece of fruit on a random free cell of the board.
+		/**
+		 * Returns false if there are no free cells left.
+		 */
+		template<typename Generator>
+		bool spawnFruit(Generator & generator) {
+			int free = grid.freeCount();
+			if (free == 0) return false;
+			std::uniform_int_distribution<int> random(0, free - 1);
+			Vector2 cell = grid.freeCell(random(generator));
+			grid.set(cell, OwnerGrid::fruit);
+			fruits.push_back(cell);
+			return true;
+		}
+
+		/// Get the number of snakes still alive.
+		int aliveCount() const;
+
+		/// Check if the game is over: all snakes died, or only one is left in a game of several.
+		bool finished() const;
+
+		/// Get the direction a snake will move in when an action is applied in the next tick.
+		Direction nextDirection(int player, Action action) const;
+
+		/// Process a game tick with one action per snake.
+		/**
+		 * Actions for dead snakes are ignored. Every eaten piece of fruit is replaced if there is room.
+		 */
+		template<typename Generator>
+		void doTick(Action const * actions, Generator & generator) {
+			int eaten = moveSnakes(actions);
+			for (int i = 0; i < eaten; ++i) spawnFruit(generator);
+		}
+
+	private:
+		/// What happens to one snake in the current tick.
+		struct Move {
+			Vector2 head;
+			Direction direction;
+			bool eating;
+			bool dies;
+		};
+
+		/// A cell targeted by at least one head in the current tick, valid if the stamp equals the generation.
+		struct HeadCell {
+			int cell;
+			int winner;
+			bool tied;
+			std::uint32_t stamp;
+		};
+
+		/// Open addressing table of head cells, with room for twice the maximum number of snakes.
+		static constexpr int head_table_size = 2 * max_players;
+
+		std::vector<Move> moves_;
+		std::vector<HeadCell> head_cells_;
+		std::uint32_t head_generation_ = 0;
+
+		/// Reset everything but the fruit.
+		void resetPlayers(int player_count);
+
+		/// Find the head cell entry for a board cell in this tick, or the free slot where it belongs.
+		HeadCell & headCell(int cell);
+
+		/// Remove the body of a snake from the board.
+		void clearBody(Player const & player);
+
+		/// Move all snakes for a tick. Returns the number of fruit eaten.
+		int moveSnakes(Action const * actions);
+	};
+}
@@ -0,0 +1,95 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace snake {
+	namespace {
+		std::runtime_error socketError(std::string const & what) {
+			return std::runtime_error(what + ": " + std::strerror(errno));
+		}
+	}
+
+	int listenTcp(int port, int backlog) {
+		int fd = ::socket(AF_INET6, SOCK_STREAM, 0);
+		if (fd < 0) throw socketError("Failed to create socket");
+
+		int on  = 1;
+		int off = 0;
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+		sockaddr_in6 address = {};
+		address.sin6_family = AF_INET6;
+		address.sin6_addr   = in6addr_any;
+		address.sin6_port   = htons(port);
+		if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(fd, backlog) != 0) {
+			std::runtime_error error = socketError("Failed to listen on port " + std::to_string(port));
+			::close(fd);
+			throw error;
+		}
+
+		setNonBlocking(fd);
+		return fd;
+	}
+
+	int connectTcp(std::string const & host, std::string const & port) {
+		addrinfo hints = {};
+		hints.ai_family   = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		addrinfo * addresses;
+		int result = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+		if (result != 0) throw std::runtime_error("Failed to resolve " + host + ": " + ::gai_strerror(result));
+
+		int fd = -1;
+		for (addrinfo * address = addresses; address; address = address->ai_next) {
+			fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			if (fd < 0) continue;
+			if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) break;
+			::close(fd);
+			fd = -1;
+		}
+		::freeaddrinfo(addresses);
+
+		if (fd < 0) throw socketError("Failed to connect to " + host + ":" + port);
+		setNoDelay(fd);
+		return fd;
+	}
+
+	void setNonBlocking(int fd) {
+		int flags = ::fcntl(fd, F_GETFL, 0);
+		if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) throw socketError("Failed to make socket non-blocking");
+	}
+
+	void setNoDelay(int fd) {
+		int on = 1;
+		::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	}
+}
@@ -0,0 +1,38 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace snake {
+	/// Open a listening TCP socket on all interfaces. Throws std::runtime_error on failure.
+	/**
+	 * The socket is non-blocking and has SO_REUSEADDR set, so a restarted server can bind right away.
+	 */
+	int listenTcp(int port, int backlog = 128);
+
+	/// Connect a blocking TCP socket to a host and port. Throws std::runtime_error on failure.
+	int connectTcp(std::string const & host, std::string const & port);
+
+	/// Make a socket non-blocking. Throws std::runtime_error on failure.
+	void setNonBlocking(int fd);
+
+	/// Disable Nagle's algorithm on a TCP socket, so small per tick messages go out immediately.
+	void setNoDelay(int fd);
+}
@@ -0,0 +1,198 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net_protocol.hpp"
+
+#include <stdexcept>
+
+namespace snake {
+	namespace {
+		void putVarint(std::vector<unsigned char> & out, std::uint64_t value) {
+			while (value >= 0x80) {
+				out.push_back((value & 0x7f) | 0x80);
+				value >>= 7;
+			}
+			out.push_back(value);
+		}
+
+		void putPoint(std::vector<unsigned char> & out, Vector2 const & point) {
+			putVarint(out, point.x);
+			putVarint(out, point.y);
+		}
+
+		/// Read a varint, advancing the read position. Returns false if the data ends early.
+		bool tryReadVarint(unsigned char const * & data, unsigned char const * end, std::uint64_t & result) {
+			result = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				if (data == end) return false;
+				unsigned char byte = *data++;
+				result |= std::uint64_t(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return true;
+			}
+			throw std::runtime_error("Invalid varint in network message.");
+		}
+
+		/// Read a varint from a complete payload. Throws std::runtime_error if the payload ends early.
+		std::uint64_t readVarint(unsigned char const * & data, unsigned char const * end) {
+			std::uint64_t result;
+			if (!tryReadVarint(data, end, result)) throw std::runtime_error("Unexpected end of network message.");
+			return result;
+		}
+
+		/// Read a point that must be inside an area.
+		Vector2 readPoint(unsigned char const * & data, unsigned char const * end, Vector2 const & area) {
+			std::uint64_t x = readVarint(data, end);
+			std::uint64_t y = readVarint(data, end);
+			if (x >= std::uint64_t(area.x) || y >= std::uint64_t(area.y)) throw std::runtime_error("Point outside of the board in network message.");
+			return {int(x), int(y)};
+		}
+
+		unsigned char gameFlags(Game const & game) {
+			return (game.alive ? net_protocol::alive : 0) | (game.won ? net_protocol::won : 0);
+		}
+
+		/// Start a message, returning the position of the payload.
+		/**
+		 * The payload size is not known yet, so one byte is reserved for it.
+		 */
+		std::size_t beginMessage(std::vector<unsigned char> & out, unsigned char type) {
+			out.push_back(type);
+			out.push_back(0);
+			return out.size();
+		}
+
+		/// Fill in the size of a message, making room for a longer varint if the payload is large.
+		void endMessage(std::vector<unsigned char> & out, std::size_t payload) {
+			std::uint64_t size = out.size() - payload;
+			if (size < 0x80) {
+				out[payload - 1] = size;
+				return;
+			}
+
+			std::vector<unsigned char> prefix;
+			putVarint(prefix, size);
+			out[payload - 1] = prefix[0];
+			out.insert(out.begin() + payload, prefix.begin() + 1, prefix.end());
+		}
+	}
+
+	void appendSnapshot(std::vector<unsigned char> & out, Game const & game) {
+		std::size_t payload = beginMessage(out, net_protocol::snapshot);
+		out.push_back(gameFlags(game));
+		putVarint(out, game.score);
+		putPoint(out, game.board_size);
+		putPoint(out, game.fruit);
+		putPoint(out, game.snake.head);
+		putVarint(out, game.snake.segments.size());
+		for (std::size_t i = 0; i < game.snake.segments.size(); ++i) {
+			Segment const & segment = game.snake.segments[i];
+			putVarint(out, std::uint64_t(segment.length) << 2 | std::uint64_t(segment.direction));
+		}
+		endMessage(out, payload);
+	}
+
+	void appendUpdate(std::vector<unsigned char> & out, DeltaBase const & before, Game const & game) {
+		if (!before.alive && game.alive) {
+			appendSnapshot(out, game);
+			return;
+		}
+
+		bool moved  = game.snake.head != before.head;
+		bool shrunk = game.snake.tail != before.tail;
+
+		std::size_t payload = beginMessage(out, net_protocol::delta);
+		out.push_back(gameFlags(game) | (moved ? net_protocol::moved : 0) | (shrunk ? net_protocol::shrunk : 0));
+		putVarint(out, game.score);
+		putPoint(out, game.fruit);
+		if (moved)  putPoint(out, game.snake.head);
+		if (shrunk) putPoint(out, before.tail);
+		endMessage(out, payload);
+	}
+
+	std::size_t RemoteGame::apply(unsigned char const * data, std::size_t size) {
+		unsigned char const * const begin = data;
+		unsigned char const * const end   = data + size;
+
+		while (data != end) {
+			unsigned char const * message = data;
+			unsigned char type = *message++;
+			std::uint64_t payload_size;
+			if (!tryReadVarint(message, end, payload_size)) break;
+			if (std::uint64_t(end - message) < payload_size) break;
+
+			unsigned char const * payload_end = message + payload_size;
+			if      (type == net_protocol::snapshot) applySnapshot(message, payload_end);
+			else if (type == net_protocol::delta)    applyDelta(message, payload_end);
+			else throw std::runtime_error("Unknown network message type.");
+			data = payload_end;
+		}
+
+		return data - begin;
+	}
+
+	void RemoteGame::applySnapshot(unsigned char const * data, unsigned char const * end) {
+		if (data == end) throw std::runtime_error("Unexpected end of network message.");
+		flags_ = *data++;
+		score_ = readVarint(data, end);
+
+		std::uint64_t width  = readVarint(data, end);
+		std::uint64_t height = readVarint(data, end);
+		if (width == 0 || height == 0 || width * height > (std::uint64_t(1) << 30)) throw std::runtime_error("Invalid board size in network message.");
+		Vector2 size = {int(width), int(height)};
+		if (field_.size() != size) field_ = Field(size);
+		field_.clear();
+
+		fruit_ = readPoint(data, end, size);
+		head_  = readPoint(data, end, size);
+
+		// Walk the segments from the head, checking every segment stays on the board.
+		Vector2 point = head_;
+		std::uint64_t segments = readVarint(data, end);
+		for (std::uint64_t i = 0; i < segments; ++i) {
+			std::uint64_t value = readVarint(data, end);
+			Direction direction = Direction(value & 3);
+			std::uint64_t length = value >> 2;
+			for (std::uint64_t j = 0; j < length; ++j) {
+				if (!pointInsideArea(point, size)) throw std::runtime_error("Snake outside of the board in network message.");
+				field_.setPixel(point, Color::white);
+				point -= directionVector(direction);
+			}
+		}
+
+		if (!won()) field_.setPixel(fruit_, Color::yellow);
+		synced_ = true;
+	}
+
+	void RemoteGame::applyDelta(unsigned char const * data, unsigned char const * end) {
+		if (!synced_) throw std::runtime_error("Received a delta before a snapshot.");
+		if (data == end) throw std::runtime_error("Unexpected end of network message.");
+		unsigned char flags = *data++;
+		flags_ = flags & (net_protocol::alive | net_protocol::won);
+		score_ = readVarint(data, end);
+		fruit_ = readPoint(data, end, field_.size());
+
+		Vector2 head = head_;
+		if (flags & net_protocol::moved) head = readPoint(data, end, field_.size());
+		if (flags & net_protocol::shrunk) field_.setPixel(readPoint(data, end, field_.size()), Color::black);
+		head_ = head;
+
+		// Fruit only moves when it is eaten, and then the new head covers the old fruit.
+		field_.setPixel(head_, Color::white);
+		if (!won()) field_.setPixel(fruit_, Color::yellow);
+	}
+}
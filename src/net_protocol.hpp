@@ -0,0 +1,109 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "field.hpp"
+#include "game.hpp"
+#include "geometry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace snake {
+	/// Live games are streamed to network clients as a full snapshot followed by one delta per tick.
+	/**
+	 * Every message is a type byte, the payload size as a varint, and the payload.
+	 * All numbers in a payload are varints, and every payload starts with the state flags and the score.
+	 *
+	 * A snapshot is sent when a client joins and whenever the game is reset. Its payload is:
+	 *  - the flags and the score,
+	 *  - the board width and height,
+	 *  - the fruit and the head position,
+	 *  - the number of segments, and (length << 2) | direction for each segment from the head to the tail.
+	 *
+	 * A delta describes one tick. Its payload is:
+	 *  - the flags and the score,
+	 *  - the fruit position,
+	 *  - the new head position if the moved flag is set,
+	 *  - the removed tail position if the shrunk flag is set.
+	 * A client applies the removed tail before the new head, since the head may move into the old tail.
+	 */
+	namespace net_protocol {
+		constexpr std::uint16_t default_port = 4307;
+
+		constexpr unsigned char snapshot = 1;
+		constexpr unsigned char delta    = 2;
+
+		constexpr unsigned char alive  = 0x1;
+		constexpr unsigned char won    = 0x2;
+		constexpr unsigned char moved  = 0x4;
+		constexpr unsigned char shrunk = 0x8;
+
+		/// Clients send single bytes holding the value of an Action.
+		constexpr unsigned char max_action = static_cast<unsigned char>(Action::reset);
+	}
+
+	/// The part of a game state a delta is computed against, taken right before a tick.
+	struct DeltaBase {
+		bool alive;
+		Vector2 head;
+		Vector2 tail;
+
+		static DeltaBase of(Game const & game) { return {game.alive, game.snake.head, game.snake.tail}; }
+	};
+
+	/// Append a snapshot message of a game.
+	void appendSnapshot(std::vector<unsigned char> & out, Game const & game);
+
+	/// Append the message for a tick: a delta, or a snapshot if the tick reset the game.
+	void appendUpdate(std::vector<unsigned char> & out, DeltaBase const & before, Game const & game);
+
+	/// A game as seen by a network client: a field that the messages of the server draw into.
+	/**
+	 * There is no copy of the snake itself, every delta only repaints the cells that changed.
+	 */
+	class RemoteGame {
+		Field field_{0, 0};
+		Vector2 head_  = {0, 0};
+		Vector2 fruit_ = {0, 0};
+		int score_     = 0;
+		unsigned char flags_ = 0;
+		bool synced_   = false;
+
+		void applySnapshot(unsigned char const * data, unsigned char const * end);
+		void applyDelta(unsigned char const * data, unsigned char const * end);
+
+	public:
+		/// Apply all complete messages at the start of a buffer. Returns the number of bytes used.
+		/**
+		 * Throws std::runtime_error on invalid messages, or on a delta before the first snapshot.
+		 */
+		std::size_t apply(unsigned char const * data, std::size_t size);
+
+		/// Check if a snapshot was received yet.
+		bool synced() const { return synced_; }
+
+		Field const & field() const { return field_; }
+		Vector2 const & head() const { return head_; }
+		int score() const { return score_; }
+		bool alive() const { return flags_ & net_protocol::alive; }
+		bool won() const { return flags_ & net_protocol::won; }
+	};
+}
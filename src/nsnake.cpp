@@ -0,0 +1,631 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ansi_printer.hpp"
+#include "autopilot.hpp"
+#include "camera.hpp"
+#include "field.hpp"
+#include "field_printer.hpp"
+#include "game.hpp"
+#include "input_queue.hpp"
+#include "latency_histogram.hpp"
+#include "net.hpp"
+#include "net_protocol.hpp"
+#include "replay.hpp"
+#include "random.hpp"
+#include "scheduler.hpp"
+#include "spsc_queue.hpp"
+#include "telemetry.hpp"
+#include "triple_buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <clocale>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cursesw.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace snake {
+	/// Translate a curses key code to a game action.
+	Action keyAction(int key) {
+		switch (key) {
+			case KEY_UP:    return Action::up;
+			case KEY_DOWN:  return Action::down;
+			case KEY_LEFT:  return Action::left;
+			case KEY_RIGHT: return Action::right;
+			case KEY_ENTER:
+			case '\n':
+			case '\r':
+				return Action::reset;
+		}
+		return Action::none;
+	}
+}
+
+/// Initialize ncurses.
+bool initNcurses() {
+	initscr();
+	cbreak();
+	noecho();
+	nonl();
+	keypad(stdscr, true);
+	curs_set(0);
+
+	start_color();
+
+	if (COLOR_PAIRS - 2 < 8 * 8) {
+		std::cerr << "Not enough color pairs available.\n";
+		return false;
+	}
+
+	for (int i = 0; i < 8; ++i) {
+		for (int j = 0; j < 8; ++j) {
+			init_pair(snake::colorIndex(snake::Color(i), snake::Color(j)), i, j);
+		}
+	}
+
+	return true;
+}
+
+void cursesBox(int y, int x, int width, int height) {
+	mvvline(y,          x,         ACS_VLINE, height);
+	mvvline(y,          x + width, ACS_VLINE, height);
+	mvhline(y,          x,         ACS_HLINE, width);
+	mvhline(y + height, x,         ACS_HLINE, width);
+	mvaddch(y,          x,         ACS_ULCORNER);
+	mvaddch(y,          x + width, ACS_URCORNER);
+	mvaddch(y + height, x,         ACS_LLCORNER);
+	mvaddch(y + height, x + width, ACS_LRCORNER);
+}
+
+/// Get the view size that fits in the terminal below the status lines, inside the box.
+/**
+ * Every terminal row holds two pixel rows.
+ */
+snake::Vector2 terminalViewSize() {
+	return {std::max(0, COLS - 2), std::max(0, (LINES - 4) * 2)};
+}
+
+/// Pack a view size in one integer, so it can be passed between threads in a single atomic.
+std::uint64_t packSize(snake::Vector2 const & size) {
+	return std::uint64_t(std::uint32_t(size.x)) << 32 | std::uint32_t(size.y);
+}
+
+snake::Vector2 unpackSize(std::uint64_t packed) {
+	return {int(packed >> 32), int(packed & 0xffffffff)};
+}
+
+/// Get the time between ticks for a given score.
+snake::TickScheduler::Duration tickInterval(int score) {
+	return std::chrono::milliseconds(10000 / (40 + score));
+}
+
+/// Everything the curses thread needs to draw one frame.
+struct Frame {
+	snake::Field field;
+	int score = 0;
+	bool autopilot = false;
+	bool replay_finished = false;
+	std::uint32_t replay_tick = 0;
+	std::string message;
+
+	explicit Frame(snake::Vector2 view_size) : field(view_size) {}
+};
+
+/// Draw the part of a game visible to a camera into a frame.
+void drawFrame(Frame & frame, snake::Camera const & camera, snake::Game const & game) {
+	drawView(frame.field, camera, game);
+	frame.score   = game.score;
+	frame.message = game.message;
+}
+
+/// Draw the part of a game received from a server visible to a camera into a frame.
+void drawFrame(Frame & frame, snake::Camera const & camera, snake::RemoteGame const & game) {
+	drawView(frame.field, camera, game.field());
+	frame.score = game.score();
+	if      (game.won())   frame.message = snake::win_message;
+	else if (game.alive()) frame.message = "";
+	else                   frame.message = snake::dead_message;
+}
+
+/// Durations of the hot paths of the frontend.
+/**
+ * The simulation thread records ticks and drawing, the curses thread records printing and refreshing.
+ */
+struct Timings {
+	snake::LatencyHistogram tick;
+	snake::LatencyHistogram draw;
+	snake::LatencyHistogram print;
+	snake::LatencyHistogram refresh;
+};
+
+/// Format a duration in nanoseconds with at most three significant digits and a unit.
+void formatDuration(char * buffer, std::size_t size, std::uint64_t nanoseconds) {
+	if      (nanoseconds < 1000)       std::snprintf(buffer, size, "%uns",   unsigned(nanoseconds));
+	else if (nanoseconds < 1000000)    std::snprintf(buffer, size, "%.3gus", nanoseconds / 1e3);
+	else if (nanoseconds < 1000000000) std::snprintf(buffer, size, "%.3gms", nanoseconds / 1e6);
+	else                               std::snprintf(buffer, size, "%.3gs",  nanoseconds / 1e9);
+}
+
+/// A one line summary of the recent timings, to show next to the score.
+/**
+ * Shows the median, 99th percentile and maximum of every hot path and the effective ticks per second,
+ * over the samples recorded since the previous update.
+ */
+class TimingOverlay {
+	using Clock = std::chrono::steady_clock;
+
+	Timings const & timings_;
+	std::array<snake::LatencyHistogram::Snapshot, 4> previous_;
+	Clock::time_point last_update_;
+	std::string text_;
+
+	std::array<snake::LatencyHistogram::Snapshot, 4> snapshots() const {
+		return {{timings_.tick.snapshot(), timings_.draw.snapshot(), timings_.print.snapshot(), timings_.refresh.snapshot()}};
+	}
+
+public:
+	explicit TimingOverlay(Timings const & timings) : timings_(timings), previous_(snapshots()), last_update_(Clock::now()) {}
+
+	/// Get the current summary.
+	std::string const & text() const { return text_; }
+
+	/// Update the summary if the last update is long enough ago to have a useful number of samples.
+	void update() {
+		Clock::time_point now = Clock::now();
+		double seconds = std::chrono::duration<double>(now - last_update_).count();
+		if (seconds < 0.5) return;
+
+		static char const * const names[] = {"tick", "draw", "print", "refresh"};
+		std::array<snake::LatencyHistogram::Snapshot, 4> current = snapshots();
+		text_.clear();
+		for (std::size_t i = 0; i < current.size(); ++i) {
+			snake::LatencyHistogram::Snapshot window = current[i] - previous_[i];
+			char p50[16], p99[16], max[16], part[80];
+			formatDuration(p50, sizeof(p50), window.quantile(0.5));
+			formatDuration(p99, sizeof(p99), window.quantile(0.99));
+			formatDuration(max, sizeof(max), window.quantile(1));
+			std::snprintf(part, sizeof(part), "%s %s/%s/%s  ", names[i], p50, p99, max);
+			text_ += part;
+		}
+
+		char rate[32];
+		std::snprintf(rate, sizeof(rate), "%.1f tps", (current[0] - previous_[0]).total() / seconds);
+		text_ += rate;
+
+		previous_    = current;
+		last_update_ = now;
+	}
+};
+
+/// Read from a socket until a complete snapshot arrived, before the game starts.
+/**
+ * Throws std::runtime_error if the connection fails or the server sends invalid data.
+ */
+void receiveSnapshot(int fd, snake::RemoteGame & game, std::vector<unsigned char> & received) {
+	unsigned char buffer[4096];
+	while (!game.synced()) {
+		ssize_t size = ::recv(fd, buffer, sizeof(buffer), 0);
+		if (size <= 0) throw std::runtime_error("Connection to the server closed.");
+		received.insert(received.end(), buffer, buffer + size);
+		received.erase(received.begin(), received.begin() + game.apply(received.data(), received.size()));
+	}
+}
+
+/// Print a frame to the terminal.
+/**
+ * The status lines always go through curses.
+ * The field is printed by the ANSI printer if there is one, after curses is done with the screen.
+ */
+void printFrame(Frame const & frame, snake::FieldPrinter & printer, snake::AnsiPrinter * ansi_printer, Timings & timings, TimingOverlay const * overlay) {
+	mvprintw(0, 0, "Score: %u%s", frame.score, frame.autopilot ? " [autopilot]" : "");
+	if (overlay) {
+		// Cut the overlay off at the edge of the terminal instead of wrapping onto the message line.
+		int room = COLS - getcurx(stdscr) - 3;
+		if (room > 0) printw(" | %.*s", room, overlay->text().c_str());
+	}
+	clrtoeol();
+	if (frame.replay_finished) {
+		mvprintw(1, 0, "Replay finished after %u ticks. Press [q] to quit.", frame.replay_tick);
+	} else {
+		mvprintw(1, 0, "%s", frame.message.c_str());
+	}
+	clrtoeol();
+
+	if (ansi_printer) {
+		snake::timed(timings.refresh, [] () { refresh(); });
+		snake::timed(timings.print, [&] () { ansi_printer->print(3, 1, frame.field); });
+	} else {
+		snake::timed(timings.print, [&] () { printer.print(stdscr, 3, 1, frame.field); });
+		snake::timed(timings.refresh, [] () { refresh(); });
+	}
+}
+
+/// Command line options of the game.
+struct Options {
+	std::string record_path;
+	std::string telemetry_path;
+	std::string replay_path;
+	std::string connect;
+	int replay_game = 0;
+	bool autopilot = false;
+	bool ansi = false;
+	bool timing = false;
+	long replay_from = 0;
+	snake::Vector2 board_size = {20, 20};
+};
+
+void printUsage(char const * name) {
+	std::cerr << "usage: " << name << " [--autopilot] [--ansi] [--timing] [--record FILE] [--telemetry FILE] [--width N] [--height N]\n";
+	std::cerr << "       " << name << " --replay FILE [--game N] [--from TICK] [--ansi] [--timing]\n";
+	std::cerr << "       " << name << " --connect HOST[:PORT] [--ansi] [--timing]\n";
+}
+
+/// Parse the command line. Returns false if the command line is invalid.
+bool parseOptions(int argc, char * * argv, Options & options) {
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		if (option == "--autopilot") {
+			options.autopilot = true;
+			continue;
+		}
+		if (option == "--ansi") {
+			options.ansi = true;
+			continue;
+		}
+		if (option == "--timing") {
+			options.timing = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for option: " << option << "\n";
+			return false;
+		}
+		char const * value = argv[++i];
+
+		if      (option == "--record")  options.record_path  = value;
+		else if (option == "--telemetry") options.telemetry_path = value;
+		else if (option == "--replay")  options.replay_path  = value;
+		else if (option == "--connect") options.connect      = value;
+		else if (option == "--game")    options.replay_game  = std::atoi(value);
+		else if (option == "--from")    options.replay_from  = std::atol(value);
+		else if (option == "--width")   options.board_size.x = std::atoi(value);
+		else if (option == "--height")  options.board_size.y = std::atoi(value);
+		else {
+			std::cerr << "unknown option: " << option << "\n";
+			return false;
+		}
+	}
+
+	if (options.board_size.x < 1 || options.board_size.y < 5) {
+		std::cerr << "the board must be at least 1x5\n";
+		return false;
+	}
+	if (!options.connect.empty() && (!options.record_path.empty() || !options.replay_path.empty())) {
+		std::cerr << "--connect can not be combined with --record or --replay\n";
+		return false;
+	}
+	if (!options.telemetry_path.empty() && (!options.connect.empty() || !options.replay_path.empty())) {
+		std::cerr << "--telemetry can only be used for local games\n";
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char * * argv) {
+	std::setlocale(LC_ALL, "");
+
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	// Initialize random device and generator.
+	// Every game gets a fresh seed so that it can be recorded.
+	std::random_device rand;
+	snake::DefaultGenerator generator;
+	auto newSeed = [&rand] () { return std::uint64_t(rand()) << 32 | rand(); };
+
+	std::unique_ptr<snake::ReplayWriter> recorder;
+	std::unique_ptr<snake::TelemetryWriter> telemetry;
+	std::unique_ptr<snake::ReplayFile> replay_file;
+	std::unique_ptr<snake::ReplayPlayer> player;
+
+	snake::Game live_game;
+	live_game.board_size = options.board_size;
+
+	// A remote game is played on a server, which sends a snapshot on connecting and a delta every tick.
+	int server = -1;
+	snake::RemoteGame remote;
+	std::vector<unsigned char> received;
+
+	try {
+		if (!options.connect.empty()) {
+			std::string host = options.connect;
+			std::string port = std::to_string(snake::net_protocol::default_port);
+			std::size_t colon = host.rfind(':');
+			if (colon != std::string::npos && host.find(':') == colon) {
+				port = host.substr(colon + 1);
+				host = host.substr(0, colon);
+			}
+			server = snake::connectTcp(host, port);
+			receiveSnapshot(server, remote, received);
+		}
+		if (!options.record_path.empty()) recorder.reset(new snake::ReplayWriter(options.record_path));
+		if (!options.telemetry_path.empty()) telemetry.reset(new snake::TelemetryWriter(options.telemetry_path));
+		if (!options.replay_path.empty()) {
+			replay_file.reset(new snake::ReplayFile(options.replay_path));
+			std::vector<snake::ReplayRecord> const & records = replay_file->records();
+			auto record = std::find_if(records.begin(), records.end(), [&] (snake::ReplayRecord const & record) {
+				return options.replay_game >= 0 && record.index == std::uint64_t(options.replay_game);
+			});
+			if (record == records.end()) {
+				std::cerr << "replay file has no game " << options.replay_game << "\n";
+				return 1;
+			}
+			player.reset(new snake::ReplayPlayer(*record));
+			player->seek(std::max(0L, options.replay_from));
+		}
+	} catch (std::exception const & e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+
+	std::uint64_t seed = newSeed();
+	snake::seedGenerator(generator, seed);
+	live_game.reset(generator);
+	if (recorder) recorder->beginGame(snake::generatorKind(generator), seed, live_game.board_size);
+
+	snake::Game const & game = player ? player->game() : live_game;
+
+	// Telemetry counts the games and ticks of the session.
+	std::uint64_t game_index = 0;
+	std::uint32_t game_ticks = 0;
+
+	if (!initNcurses()) {
+		endwin();
+		return 1;
+	}
+
+	// Show as much of the board as fits below the status lines, inside the box.
+	// The camera belongs to the simulation thread, the curses thread requests a new view size when the terminal is resized.
+	snake::Vector2 board_size = server >= 0 ? remote.field().size() : game.board_size;
+	snake::Camera camera(board_size, terminalViewSize());
+	std::atomic<std::uint64_t> view_request{packSize(terminalViewSize())};
+	std::uint64_t view_applied = view_request.load();
+
+	// The game runs on its own thread, so a slow terminal can not delay the ticks.
+	// Frames are handed to the curses thread through a triple buffer and keys come back through a queue.
+	// Curses itself is only ever touched from the main thread.
+	snake::TripleBuffer<Frame> frames{Frame(camera.size())};
+	snake::SpscQueue<snake::Action, 16> keys;
+	std::atomic<bool> autopilot_enabled{options.autopilot};
+	std::atomic<bool> quit{false};
+	std::exception_ptr simulation_error;
+	Timings timings;
+
+	// Resize the camera if requested, and the field of a frame to the view size.
+	// Each of the three frames is resized when it is reused, keeping the capacity of its field.
+	auto prepareFrame = [&] () -> Frame & {
+		std::uint64_t request = view_request.load(std::memory_order_relaxed);
+		if (request != view_applied) {
+			camera.resize(unpackSize(request));
+			view_applied = request;
+		}
+
+		Frame & frame = frames.back();
+		if (frame.field.size() != camera.size()) frame.field.resize(camera.size());
+		return frame;
+	};
+
+	auto publishFrame = [&] () {
+		Frame & frame = prepareFrame();
+		camera.follow(game.snake.head);
+		snake::timed(timings.draw, [&] () { drawFrame(frame, camera, game); });
+		frame.autopilot       = autopilot_enabled.load(std::memory_order_relaxed) && !player;
+		frame.replay_finished = player && player->finished();
+		frame.replay_tick     = player ? player->tick() : 0;
+		frames.publish();
+	};
+
+	auto publishRemoteFrame = [&] () {
+		Frame & frame = prepareFrame();
+		camera.follow(remote.head());
+		snake::timed(timings.draw, [&] () { drawFrame(frame, camera, remote); });
+		frames.publish();
+	};
+
+	// Instead of running the game, forward keys to the server and apply its messages.
+	auto follow = [&] () {
+		try {
+			publishRemoteFrame();
+			unsigned char buffer[4096];
+			while (!quit.load(std::memory_order_relaxed)) {
+				pollfd poll_fd = {server, POLLIN, 0};
+				::poll(&poll_fd, 1, 10);
+
+				unsigned char actions[16];
+				std::size_t count = 0;
+				snake::Action key;
+				while (count < sizeof(actions) && keys.pop(key)) actions[count++] = static_cast<unsigned char>(key);
+				if (count > 0) ::send(server, actions, count, MSG_NOSIGNAL);
+
+				// Do not wait for the server to show a resized view.
+				if (view_request.load(std::memory_order_relaxed) != view_applied) publishRemoteFrame();
+
+				if (!(poll_fd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+				ssize_t size = ::recv(server, buffer, sizeof(buffer), MSG_DONTWAIT);
+				if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+				if (size <= 0) throw std::runtime_error("Connection to the server closed.");
+
+				// Applying the messages of the server is the closest thing to a tick here.
+				snake::timed(timings.tick, [&] () {
+					received.insert(received.end(), buffer, buffer + size);
+					received.erase(received.begin(), received.begin() + remote.apply(received.data(), received.size()));
+				});
+				publishRemoteFrame();
+			}
+		} catch (...) {
+			simulation_error = std::current_exception();
+			quit = true;
+		}
+	};
+
+	auto simulate = [&] () {
+		try {
+			snake::TickScheduler scheduler(tickInterval(game.score));
+			snake::InputQueue input;
+			// The autopilot allocates its search buffers on first use, which matters on large boards.
+			snake::Autopilot autopilot;
+			publishFrame();
+
+			while (true) {
+				scheduler.waitForDeadline();
+				if (quit.load(std::memory_order_relaxed)) break;
+
+				// Queue the keys pressed since the last tick, then update the game.
+				snake::Action key;
+				while (keys.pop(key)) input.push(key);
+
+				auto tick_start = std::chrono::steady_clock::now();
+				bool was_alive  = game.alive;
+				if (player) {
+					player->step();
+				} else {
+					snake::Action action = input.pop();
+					if (autopilot_enabled.load(std::memory_order_relaxed) && live_game.alive) action = autopilot.plan(live_game);
+
+					// Reseed the generator before a reset, so the new game can be recorded.
+					bool resetting = !live_game.alive && action == snake::Action::reset;
+					if (resetting) {
+						seed = newSeed();
+						snake::seedGenerator(generator, seed);
+					}
+
+					if (recorder) recorder->recordTick(live_game, action);
+					live_game.doTick(action, generator);
+
+					if (recorder && resetting) recorder->beginGame(snake::generatorKind(generator), seed, live_game.board_size);
+					if (recorder && was_alive && !live_game.alive) recorder->endGame(live_game);
+				}
+				auto tick_duration = std::chrono::steady_clock::now() - tick_start;
+				timings.tick.record(tick_duration);
+
+				if (telemetry && was_alive) {
+					telemetry->producer(0).recordTick(snake::tickSample(game_index, game_ticks, tick_duration));
+					++game_ticks;
+					if (!live_game.alive) {
+						telemetry->producer(0).recordGame(snake::gameMetrics(game_index++, live_game, game_ticks));
+						game_ticks = 0;
+					}
+				}
+				scheduler.setInterval(tickInterval(game.score));
+				scheduler.endTick();
+				publishFrame();
+			}
+		} catch (...) {
+			simulation_error = std::current_exception();
+			quit = true;
+		}
+	};
+
+	snake::FieldPrinter printer;
+	std::unique_ptr<snake::AnsiPrinter> ansi_printer;
+	if (options.ansi) ansi_printer.reset(new snake::AnsiPrinter(STDOUT_FILENO));
+
+	// The curses thread keeps its own camera, only to know the view size the simulation thread will use after a resize.
+	// The box and everything else is redrawn from scratch once the first frame with the new size arrives.
+	snake::Camera layout(board_size, terminalViewSize());
+	bool layout_changed = true;
+
+	// The timings are always recorded and summarized, the overlay only toggles whether the summary is shown.
+	TimingOverlay timing_overlay(timings);
+	bool show_timing = options.timing;
+
+	std::thread simulation;
+	if (server >= 0) simulation = std::thread(follow);
+	else             simulation = std::thread(simulate);
+
+	// Poll for keys with a short timeout, and print the newest frame whenever there is one.
+	// Frames published while printing are skipped rather than queued.
+	timeout(10);
+	while (!quit.load(std::memory_order_relaxed)) {
+		int key = getch();
+		if (key == 27 || key == 'q') break;
+		if (key == 'a') {
+			autopilot_enabled = !autopilot_enabled;
+		} else if (key == 't') {
+			show_timing = !show_timing;
+		} else if (key == KEY_RESIZE) {
+			layout.resize(terminalViewSize());
+			view_request = packSize(layout.size());
+			layout_changed = true;
+		} else if (key != ERR) {
+			snake::Action action = snake::keyAction(key);
+			if (action != snake::Action::none) keys.push(action);
+		}
+
+		timing_overlay.update();
+		// Frames drawn before the simulation thread saw a resize have the old size and are skipped.
+		bool fresh = frames.update();
+		if ((fresh || layout_changed) && frames.front().field.size() == layout.size()) {
+			if (layout_changed) {
+				clear();
+				cursesBox(2, 0, layout.size().x + 1, (layout.size().y + 1) / 2 + 1);
+				printer.invalidate();
+				if (ansi_printer) ansi_printer->invalidate();
+				layout_changed = false;
+			}
+			printFrame(frames.front(), printer, ansi_printer.get(), timings, show_timing ? &timing_overlay : nullptr);
+		}
+	}
+
+	quit = true;
+	simulation.join();
+	endwin();
+	if (server >= 0) ::close(server);
+
+	if (telemetry && game_ticks > 0) telemetry->producer(0).recordGame(snake::gameMetrics(game_index, live_game, game_ticks));
+	try {
+		if (simulation_error) std::rethrow_exception(simulation_error);
+		if (recorder) {
+			recorder->endGame(live_game);
+			recorder->flush();
+		}
+	} catch (std::exception const & e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+}
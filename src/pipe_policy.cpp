@@ -0,0 +1,138 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pipe_policy.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace snake {
+	namespace {
+		std::runtime_error pipeError(std::string const & what) {
+			return std::runtime_error(what + ": " + std::strerror(errno));
+		}
+
+		/// Append a number and a space to a line.
+		void putNumber(std::string & line, int value) {
+			char buffer[16];
+			int size = std::snprintf(buffer, sizeof(buffer), "%d ", value);
+			line.append(buffer, size);
+		}
+	}
+
+	PipePolicy::PipePolicy(std::string const & command) {
+		int input[2];
+		int output[2];
+		if (::pipe(input) != 0) throw pipeError("Failed to create pipe");
+		if (::pipe(output) != 0) {
+			::close(input[0]);
+			::close(input[1]);
+			throw pipeError("Failed to create pipe");
+		}
+
+		child_ = ::fork();
+		if (child_ < 0) {
+			for (int fd : {input[0], input[1], output[0], output[1]}) ::close(fd);
+			throw pipeError("Failed to start policy");
+		}
+
+		if (child_ == 0) {
+			::dup2(input[0], STDIN_FILENO);
+			::dup2(output[1], STDOUT_FILENO);
+			for (int fd : {input[0], input[1], output[0], output[1]}) ::close(fd);
+			::execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+			::_exit(127);
+		}
+
+		::close(input[0]);
+		::close(output[1]);
+		::fcntl(input[1], F_SETFD, FD_CLOEXEC);
+		::fcntl(output[0], F_SETFD, FD_CLOEXEC);
+		to_   = ::fdopen(input[1], "w");
+		from_ = ::fdopen(output[0], "r");
+		if (!to_ || !from_) {
+			// The destructor does not run for a constructor that throws, so close the pipes and reap the child here.
+			std::runtime_error error = pipeError("Failed to open pipes of policy");
+			if (!to_)   ::close(input[1]);
+			if (!from_) ::close(output[0]);
+			close();
+			throw error;
+		}
+	}
+
+	PipePolicy::~PipePolicy() {
+		close();
+	}
+
+	void PipePolicy::close() {
+		// Closing the input of the program tells it to exit.
+		if (to_)   std::fclose(to_);
+		if (from_) std::fclose(from_);
+		if (child_ > 0) ::waitpid(child_, nullptr, 0);
+		to_    = nullptr;
+		from_  = nullptr;
+		child_ = -1;
+	}
+
+	Action PipePolicy::plan(Game const & game) {
+		if (!game.alive) return Action::none;
+
+		line_.clear();
+		putNumber(line_, game.board_size.x);
+		putNumber(line_, game.board_size.y);
+		putNumber(line_, game.score);
+		putNumber(line_, game.fruit.x);
+		putNumber(line_, game.fruit.y);
+		putNumber(line_, game.snake.length);
+
+		Vector2 point = game.snake.head;
+		for (std::size_t i = 0; i < game.snake.segments.size(); ++i) {
+			Segment const & segment = game.snake.segments[i];
+			for (int j = 0; j < segment.length; ++j) {
+				putNumber(line_, point.x);
+				putNumber(line_, point.y);
+				point -= directionVector(segment.direction);
+			}
+		}
+		line_.back() = '\n';
+
+		if (std::fwrite(line_.data(), 1, line_.size(), to_) != line_.size() || std::fflush(to_) != 0) {
+			throw std::runtime_error("Failed to write to policy, did it exit?");
+		}
+
+		// Read a whole line, however long, but only look at the first letter.
+		int first = std::fgetc(from_);
+		int c     = first;
+		while (c != '\n' && c != EOF) c = std::fgetc(from_);
+		if (c == EOF) throw std::runtime_error("Policy closed its output.");
+
+		switch (first) {
+			case 'u': return Action::up;
+			case 'd': return Action::down;
+			case 'l': return Action::left;
+			case 'r': return Action::right;
+		}
+		return Action::none;
+	}
+}
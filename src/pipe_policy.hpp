@@ -0,0 +1,65 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+
+#include <cstdio>
+#include <string>
+#include <sys/types.h>
+
+namespace snake {
+	/// A policy played by an external program, which talks to the game over its standard input and output.
+	/**
+	 * Before every tick of a live game the program gets one line with the space separated numbers:
+	 *  - the board width and height, the score, the fruit x and y,
+	 *  - the length of the snake, followed by the x and y of every cell of the snake from the head to the tail.
+	 *
+	 * It answers with one line holding "up", "down", "left", "right" or "none".
+	 * Only the first letter is looked at, anything else counts as "none".
+	 * The program runs for as long as the policy exists and plays any number of games, one after the other.
+	 */
+	class PipePolicy {
+		pid_t child_      = -1;
+		std::FILE * to_   = nullptr;
+		std::FILE * from_ = nullptr;
+		std::string line_;
+
+		/// Close whichever pipes are open and wait for the program to exit.
+		void close();
+
+	public:
+		/// Start a program with /bin/sh. Throws std::runtime_error if it can not be started.
+		/**
+		 * Policies are best started before any other threads, so no other child inherits the pipes.
+		 */
+		explicit PipePolicy(std::string const & command);
+		PipePolicy(PipePolicy const &) = delete;
+		PipePolicy & operator=(PipePolicy const &) = delete;
+
+		/// Close the pipes and wait for the program to exit.
+		~PipePolicy();
+
+		/// Ask the program for the action for the next tick of a game.
+		/**
+		 * Throws std::runtime_error if the program exits or the pipe breaks.
+		 */
+		Action plan(Game const & game);
+	};
+}
@@ -0,0 +1,140 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace snake {
+	/// A small and fast random number generator (PCG-XSH-RR with 64 bits of state).
+	/**
+	 * The whole state is a single 64 bit integer, compared to the 2.5 KiB of std::mt19937,
+	 * which matters when many games are kept in memory at once.
+	 * Satisfies the UniformRandomBitGenerator requirements, so it works with the standard distributions.
+	 */
+	class Pcg32 {
+		static constexpr std::uint64_t multiplier = 6364136223846793005ull;
+		static constexpr std::uint64_t increment  = 1442695040888963407ull;
+
+		std::uint64_t state_ = 0x853c49e6748fea9bull;
+
+	public:
+		using result_type = std::uint32_t;
+
+		Pcg32() = default;
+		explicit Pcg32(std::uint64_t seed) { this->seed(seed); }
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return 0xffffffffu; }
+
+		/// Seed the generator.
+		void seed(std::uint64_t seed) {
+			state_ = 0;
+			(*this)();
+			state_ += seed;
+			(*this)();
+		}
+
+		/// Generate the next random number.
+		result_type operator() () {
+			std::uint64_t old = state_;
+			state_ = old * multiplier + increment;
+			std::uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+			std::uint32_t rotation   = old >> 59;
+			return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+		}
+
+		/// Get the raw state of the generator.
+		std::uint64_t state() const { return state_; }
+
+		/// Set the raw state of the generator, as returned by state().
+		void setState(std::uint64_t state) { state_ = state; }
+
+		friend bool operator==(Pcg32 const & a, Pcg32 const & b) { return a.state_ == b.state_; }
+		friend bool operator!=(Pcg32 const & a, Pcg32 const & b) { return a.state_ != b.state_; }
+	};
+
+	/// Mix a master seed and an index into an independent seed.
+	/**
+	 * This is the splitmix64 finalizer, so consecutive indices give unrelated seeds.
+	 */
+	inline std::uint64_t mixSeed(std::uint64_t master_seed, std::uint64_t index) {
+		std::uint64_t z = master_seed + (index + 1) * 0x9e3779b97f4a7c15ull;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	/// The generator used for games unless specified otherwise.
+	using DefaultGenerator = Pcg32;
+
+	/// The kinds of generators that can be recorded in replays.
+	enum class GeneratorKind : unsigned char {
+		mt19937 = 0,
+		pcg32   = 1,
+	};
+
+	/// Get the kind of a generator type.
+	inline GeneratorKind generatorKind(std::mt19937 const &) { return GeneratorKind::mt19937; }
+	inline GeneratorKind generatorKind(Pcg32 const &)        { return GeneratorKind::pcg32; }
+
+	/// Seed a generator from a 64 bit seed.
+	inline void seedGenerator(std::mt19937 & generator, std::uint64_t seed) {
+		std::seed_seq sequence{std::uint32_t(seed), std::uint32_t(seed >> 32)};
+		generator.seed(sequence);
+	}
+
+	/// Seed a generator from a 64 bit seed.
+	inline void seedGenerator(Pcg32 & generator, std::uint64_t seed) {
+		generator.seed(seed);
+	}
+
+	/// Append the state of a generator to a buffer, as 8 little endian bytes.
+	inline void saveGeneratorState(std::vector<unsigned char> & out, Pcg32 const & generator) {
+		for (int i = 0; i < 8; ++i) out.push_back(generator.state() >> (8 * i));
+	}
+
+	/// Append the state of a generator to a buffer, in the text format of the standard library.
+	inline void saveGeneratorState(std::vector<unsigned char> & out, std::mt19937 const & generator) {
+		std::ostringstream stream;
+		stream << generator;
+		std::string text = stream.str();
+		out.insert(out.end(), text.begin(), text.end());
+	}
+
+	/// Restore the state of a generator saved with saveGeneratorState(). Throws std::runtime_error on invalid data.
+	inline void loadGeneratorState(unsigned char const * data, std::size_t size, Pcg32 & generator) {
+		if (size != 8) throw std::runtime_error("Invalid generator state.");
+		std::uint64_t state = 0;
+		for (int i = 0; i < 8; ++i) state |= std::uint64_t(data[i]) << (8 * i);
+		generator.setState(state);
+	}
+
+	/// Restore the state of a generator saved with saveGeneratorState(). Throws std::runtime_error on invalid data.
+	inline void loadGeneratorState(unsigned char const * data, std::size_t size, std::mt19937 & generator) {
+		std::istringstream stream(std::string(reinterpret_cast<char const *>(data), size));
+		stream >> generator;
+		if (!stream) throw std::runtime_error("Invalid generator state.");
+	}
+}
@@ -0,0 +1,257 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snake {
+	namespace {
+		/// Read a varint, advancing the read position. Throws std::runtime_error if the data ends early.
+		std::uint64_t readVarint(unsigned char const * & data, unsigned char const * end) {
+			std::uint64_t result = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				if (data == end) throw std::runtime_error("Unexpected end of replay data.");
+				unsigned char byte = *data++;
+				result |= std::uint64_t(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return result;
+			}
+			throw std::runtime_error("Invalid varint in replay data.");
+		}
+	}
+
+	ReplayWriter::ReplayWriter(std::string const & path, std::size_t flush_size) : flush_size_(flush_size) {
+		// Writes always go to the end of the file, but the header of an existing file is read back first.
+		file_ = std::fopen(path.c_str(), "a+b");
+		if (!file_) throw std::runtime_error("Failed to open replay file for writing: " + path);
+		buffer_.reserve(flush_size_ * 2);
+
+		// Only write a header to new files, so games can be appended to existing replays.
+		// Existing files must have the current version, or the new records would be read with the layout of the old one.
+		std::fseek(file_, 0, SEEK_END);
+		if (std::ftell(file_) == 0) {
+			buffer_.insert(buffer_.end(), replay_format::magic, replay_format::magic + 4);
+			buffer_.push_back(replay_format::version);
+			return;
+		}
+
+		unsigned char header[replay_format::header_size];
+		std::rewind(file_);
+		bool valid = std::fread(header, 1, sizeof(header), file_) == sizeof(header) && std::memcmp(header, replay_format::magic, 4) == 0;
+		if (!valid || header[4] != replay_format::version) {
+			std::fclose(file_);
+			if (!valid) throw std::runtime_error("Can not append to a file that is not a replay: " + path);
+			throw std::runtime_error("Can not append to a replay with a different version: " + path);
+		}
+
+		// Continue the numbering of the games in the file.
+		try {
+			ReplayFile existing(path);
+			if (!existing.records().empty()) next_index_ = existing.records().back().index + 1;
+		} catch (...) {
+			std::fclose(file_);
+			throw;
+		}
+	}
+
+	ReplayWriter::~ReplayWriter() {
+		// A destructor can not report errors, callers that want to know should flush() first.
+		try {
+			flush();
+		} catch (std::runtime_error const &) {}
+		std::fclose(file_);
+	}
+
+	void ReplayWriter::putVarint(std::uint64_t value) {
+		while (value >= 0x80) {
+			buffer_.push_back((value & 0x7f) | 0x80);
+			value >>= 7;
+		}
+		buffer_.push_back(value);
+	}
+
+	void ReplayWriter::beginGame(GeneratorKind generator, std::uint64_t seed, Vector2 const & board_size) {
+		buffer_.push_back(static_cast<unsigned char>(generator));
+		for (int i = 0; i < 8; ++i) buffer_.push_back(seed >> (8 * i));
+		putVarint(next_index_++);
+		putVarint(board_size.x);
+		putVarint(board_size.y);
+		recording_   = true;
+		tick_        = 0;
+		last_change_ = 0;
+	}
+
+	void ReplayWriter::recordTick(Game const & game, Action action) {
+		if (!recording_ || !game.alive) return;
+		++tick_;
+
+		Direction direction = game.nextDirection(action);
+		if (direction == game.snake.segments.front().direction) return;
+		putVarint((std::uint64_t(tick_ - last_change_) << 2) | std::uint64_t(direction));
+		last_change_ = tick_;
+	}
+
+	void ReplayWriter::endGame(Game const & game) {
+		if (!recording_) return;
+		putVarint(0);
+		putVarint(tick_);
+		putVarint(game.score);
+		recording_ = false;
+		if (buffer_.size() >= flush_size_) flush();
+	}
+
+	void ReplayWriter::flush() {
+		if (buffer_.empty()) return;
+		// The buffer is dropped even if writing fails, so a failing file does not make it grow without bound.
+		bool written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size() && std::fflush(file_) == 0;
+		buffer_.clear();
+		if (!written) {
+			throw std::runtime_error(std::string("Failed to write replay file: ") + std::strerror(errno));
+		}
+	}
+
+	std::vector<ReplayRecord> parseReplay(unsigned char const * data, std::size_t size) {
+		unsigned char const * end = data + size;
+		if (size < replay_format::header_size || std::memcmp(data, replay_format::magic, 4) != 0) {
+			throw std::runtime_error("Not a replay file.");
+		}
+		unsigned char version = data[4];
+		if (version < 1 || version > replay_format::version) throw std::runtime_error("Unsupported replay version.");
+		data += replay_format::header_size;
+
+		std::vector<ReplayRecord> records;
+		while (data != end) {
+			ReplayRecord record;
+			record.generator = GeneratorKind::mt19937;
+			if (version >= 2) {
+				if (*data > static_cast<unsigned char>(GeneratorKind::pcg32)) throw std::runtime_error("Unknown generator in replay data.");
+				record.generator = GeneratorKind(*data++);
+			}
+			if (end - data < 8) throw std::runtime_error("Unexpected end of replay data.");
+			record.seed = 0;
+			for (int i = 0; i < 8; ++i) record.seed |= std::uint64_t(*data++) << (8 * i);
+			record.index = version >= 3 ? readVarint(data, end) : records.size();
+			record.board_size.x = readVarint(data, end);
+			record.board_size.y = readVarint(data, end);
+
+			record.changes_begin = data;
+			while (readVarint(data, end) != 0);
+			record.changes_end = data;
+
+			record.ticks = readVarint(data, end);
+			record.score = readVarint(data, end);
+			records.push_back(record);
+		}
+		return records;
+	}
+
+	ReplayFile::ReplayFile(std::string const & path) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error("Failed to open replay file: " + path);
+
+		struct stat info;
+		if (::fstat(fd, &info) != 0) {
+			::close(fd);
+			throw std::runtime_error("Failed to stat replay file: " + path);
+		}
+
+		size_ = info.st_size;
+		if (size_ > 0) data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data_ == MAP_FAILED) {
+			data_ = nullptr;
+			throw std::runtime_error("Failed to map replay file: " + path);
+		}
+
+		try {
+			records_ = parseReplay(static_cast<unsigned char const *>(data_), size_);
+		} catch (...) {
+			if (data_) ::munmap(data_, size_);
+			throw;
+		}
+	}
+
+	ReplayFile::~ReplayFile() {
+		if (data_) ::munmap(data_, size_);
+	}
+
+	ReplayPlayer::ReplayPlayer(ReplayRecord const & record) : record_(record) {
+		restart();
+	}
+
+	void ReplayPlayer::load(ReplayRecord const & record) {
+		record_ = record;
+		restart();
+	}
+
+	void ReplayPlayer::readChange() {
+		// The list of changes ends with a zero, which never matches a tick.
+		std::uint64_t value = readVarint(next_change_, record_.changes_end);
+		if (value == 0) {
+			next_change_tick_ = 0;
+			return;
+		}
+		next_change_tick_      += value >> 2;
+		next_change_direction_  = Direction(value & 3);
+	}
+
+	void ReplayPlayer::restart() {
+		game_.board_size = record_.board_size;
+		if (record_.generator == GeneratorKind::mt19937) {
+			seedGenerator(mt19937_, record_.seed);
+			game_.reset(mt19937_);
+		} else {
+			seedGenerator(pcg32_, record_.seed);
+			game_.reset(pcg32_);
+		}
+
+		tick_             = 0;
+		next_change_      = record_.changes_begin;
+		next_change_tick_ = 0;
+		readChange();
+	}
+
+	bool ReplayPlayer::step() {
+		if (finished()) return false;
+		++tick_;
+
+		Action action = Action::none;
+		if (tick_ == next_change_tick_) {
+			action = directionAction(next_change_direction_);
+			readChange();
+		}
+		if (record_.generator == GeneratorKind::mt19937) {
+			game_.doTick(action, mt19937_);
+		} else {
+			game_.doTick(action, pcg32_);
+		}
+		return true;
+	}
+
+	void ReplayPlayer::seek(std::uint32_t tick) {
+		if (tick < tick_) restart();
+		while (tick_ < tick && step());
+	}
+}
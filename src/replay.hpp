@@ -0,0 +1,179 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "geometry.hpp"
+#include "random.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace snake {
+	/// Games are recorded as a seed, a board size and the direction changes of the snake.
+	/**
+	 * A replay file starts with the magic bytes "NSRP" and a version byte,
+	 * followed by any number of game records. Each record is:
+	 *  - one byte with the GeneratorKind of the game (missing in version 1, which always used std::mt19937),
+	 *  - the 64 bit little endian seed the generator was seeded with before the game was reset,
+	 *  - the index of the game as a varint (missing before version 3, where it is the position of the record in the file),
+	 *  - the board width and height as varints,
+	 *  - one varint per direction change, holding (tick delta << 2) | direction,
+	 *    where the tick delta counts from the previous change (or the start of the game),
+	 *  - a zero varint to end the list of changes,
+	 *  - the total number of ticks and the final score as varints.
+	 *
+	 * Since a tick can change the direction at most once, the tick delta of a change is never zero.
+	 * All other ticks are replayed with Action::none, so only direction changes need to be stored.
+	 * Games appended to a file continue the numbering of the games already in it,
+	 * so tournaments can look up games by index instead of trusting their position.
+	 */
+	namespace replay_format {
+		constexpr char magic[4] = {'N', 'S', 'R', 'P'};
+		constexpr unsigned char version = 3;
+		constexpr std::size_t header_size = 5;
+	}
+
+	/// A parsed game record of a replay.
+	struct ReplayRecord {
+		GeneratorKind generator;
+		std::uint64_t seed;
+		std::uint64_t index;
+		Vector2 board_size;
+		std::uint32_t ticks;
+		std::uint32_t score;
+
+		/// The encoded direction changes, which still reference the replay data.
+		unsigned char const * changes_begin;
+		unsigned char const * changes_end;
+	};
+
+	/// Records games to a replay file.
+	/**
+	 * Records are built in a memory buffer that is appended to the file in large chunks,
+	 * so recording a tick never waits for the disk.
+	 */
+	class ReplayWriter {
+		std::FILE * file_ = nullptr;
+		std::vector<unsigned char> buffer_;
+		std::size_t flush_size_;
+
+		bool recording_ = false;
+		std::uint64_t next_index_ = 0;
+		std::uint32_t tick_;
+		std::uint32_t last_change_;
+
+		void putVarint(std::uint64_t value);
+
+	public:
+		/// Open a replay file for appending. Throws std::runtime_error if the file can not be opened or is not a valid replay of the current version.
+		explicit ReplayWriter(std::string const & path, std::size_t flush_size = 64 * 1024);
+		ReplayWriter(ReplayWriter const &) = delete;
+		ReplayWriter & operator=(ReplayWriter const &) = delete;
+		~ReplayWriter();
+
+		/// Start recording a game that was reset right after seeding the generator with the given seed.
+		/**
+		 * The game gets the index after the last game in the file.
+		 */
+		void beginGame(GeneratorKind generator, std::uint64_t seed, Vector2 const & board_size);
+
+		/// Record the action for the next tick of the game. Must be called before the tick is processed.
+		void recordTick(Game const & game, Action action);
+
+		/// Finish recording the current game, if any.
+		void endGame(Game const & game);
+
+		/// Write all buffered data to the file. Throws std::runtime_error if writing fails.
+		/**
+		 * Recording a game flushes once enough data is buffered, so endGame() can throw too.
+		 * The destructor flushes as well but ignores errors, so flush before destroying the writer to see them.
+		 */
+		void flush();
+	};
+
+	/// Read-only access to a memory mapped replay file.
+	class ReplayFile {
+		void * data_      = nullptr;
+		std::size_t size_ = 0;
+		std::vector<ReplayRecord> records_;
+
+	public:
+		/// Map a replay file and index the records. Throws std::runtime_error on invalid files.
+		explicit ReplayFile(std::string const & path);
+		ReplayFile(ReplayFile const &) = delete;
+		ReplayFile & operator=(ReplayFile const &) = delete;
+		~ReplayFile();
+
+		/// Get all records in the file.
+		std::vector<ReplayRecord> const & records() const { return records_; }
+	};
+
+	/// Parse replay records from a buffer. Throws std::runtime_error on invalid data.
+	std::vector<ReplayRecord> parseReplay(unsigned char const * data, std::size_t size);
+
+	/// Re-simulates a recorded game.
+	class ReplayPlayer {
+		ReplayRecord record_;
+		std::mt19937 mt19937_;
+		Pcg32 pcg32_;
+		Game game_;
+
+		std::uint32_t tick_;
+		unsigned char const * next_change_;
+		std::uint32_t next_change_tick_;
+		Direction next_change_direction_;
+
+		void readChange();
+
+	public:
+		explicit ReplayPlayer(ReplayRecord const & record);
+
+		/// Switch to another record and start it from the beginning, reusing the game.
+		void load(ReplayRecord const & record);
+
+		/// Restart the game from the beginning.
+		void restart();
+
+		/// Get the game being replayed.
+		Game const & game() const { return game_; }
+
+		/// Get the number of ticks replayed so far.
+		std::uint32_t tick() const { return tick_; }
+
+		/// Check if all recorded ticks have been replayed.
+		bool finished() const { return tick_ >= record_.ticks; }
+
+		/// Replay one tick. Returns false if the replay is already finished.
+		bool step();
+
+		/// Replay as fast as possible until the given tick, without rendering.
+		/**
+		 * Seeking backwards restarts the game from the beginning.
+		 */
+		void seek(std::uint32_t tick);
+
+		/// Check if the replayed game ended with the recorded score.
+		bool verified() const { return finished() && std::uint32_t(game_.score) == record_.score; }
+	};
+}
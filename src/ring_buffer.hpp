@@ -0,0 +1,107 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace snake {
+	/// A double ended queue of elements stored in a circular buffer.
+	/**
+	 * Pushing to the front and popping from the back are constant time.
+	 * The capacity is always a power of two and only grows when the buffer is full,
+	 * so a buffer that is reused does not allocate once it reached its working size.
+	 */
+	template<typename T>
+	class RingBuffer {
+		std::vector<T> data_;
+		std::size_t start_ = 0;
+		std::size_t size_  = 0;
+
+		std::size_t mask() const { return data_.size() - 1; }
+
+		/// Grow the buffer to a new power of two capacity, moving the elements to the start of the buffer.
+		void grow(std::size_t capacity) {
+			std::vector<T> data(capacity);
+			for (std::size_t i = 0; i < size_; ++i) data[i] = (*this)[i];
+			data_.swap(data);
+			start_ = 0;
+		}
+
+	public:
+		RingBuffer(std::size_t capacity = 16) { reserve(capacity); }
+
+		/// Get the number of elements in the buffer.
+		std::size_t size() const { return size_; }
+
+		/// Check if the buffer is empty.
+		bool empty() const { return size_ == 0; }
+
+		/// Get the number of elements the buffer can hold without growing.
+		std::size_t capacity() const { return data_.size(); }
+
+		/// Make sure the buffer can hold at least the given number of elements without growing.
+		void reserve(std::size_t capacity) {
+			std::size_t rounded = 1;
+			while (rounded < capacity) rounded *= 2;
+			if (rounded > data_.size()) grow(rounded);
+		}
+
+		/// Remove all elements, keeping the capacity.
+		void clear() {
+			start_ = 0;
+			size_  = 0;
+		}
+
+		/// Get an element by index, where index 0 is the front of the buffer.
+		T       & operator[] (std::size_t i)       { return data_[(start_ + i) & mask()]; }
+		T const & operator[] (std::size_t i) const { return data_[(start_ + i) & mask()]; }
+
+		T       & front()       { return (*this)[0]; }
+		T const & front() const { return (*this)[0]; }
+		T       & back()        { return (*this)[size_ - 1]; }
+		T const & back()  const { return (*this)[size_ - 1]; }
+
+		/// Add an element to the front of the buffer.
+		void push_front(T const & value) {
+			if (size_ == data_.size()) grow(data_.size() * 2);
+			start_ = (start_ - 1) & mask();
+			++size_;
+			front() = value;
+		}
+
+		/// Add an element to the back of the buffer.
+		void push_back(T const & value) {
+			if (size_ == data_.size()) grow(data_.size() * 2);
+			++size_;
+			back() = value;
+		}
+
+		/// Remove the element at the front of the buffer.
+		void pop_front() {
+			start_ = (start_ + 1) & mask();
+			--size_;
+		}
+
+		/// Remove the element at the back of the buffer.
+		void pop_back() {
+			--size_;
+		}
+	};
+}
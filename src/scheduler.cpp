@@ -0,0 +1,44 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scheduler.hpp"
+
+#include <thread>
+
+namespace snake {
+	TickScheduler::TickScheduler(Duration interval, int max_behind) :
+		interval_(interval),
+		max_behind_(max_behind) {
+		start();
+	}
+
+	void TickScheduler::start(Clock::time_point now) {
+		deadline_ = now + interval_;
+	}
+
+	void TickScheduler::waitForDeadline() const {
+		std::this_thread::sleep_until(deadline_);
+	}
+
+	void TickScheduler::endTick(Clock::time_point now) {
+		deadline_ += interval_;
+
+		// If we fell too far behind, start over instead of trying to catch up.
+		if (now - deadline_ > interval_ * max_behind_) start(now);
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace snake {
+	/// Schedules game ticks at absolute deadlines of a steady clock.
+	/**
+	 * Deadlines advance by exactly one interval per tick, so the time spent
+	 * ticking and rendering does not make the tick rate drift.
+	 * Rendering happens on another thread, so a slow terminal does not delay the ticks.
+	 * If the loop falls too far behind the schedule is restarted from the current time,
+	 * rather than running a long burst of ticks.
+	 */
+	class TickScheduler {
+	public:
+		using Clock    = std::chrono::steady_clock;
+		using Duration = Clock::duration;
+
+	private:
+		Clock::time_point deadline_;
+		Duration interval_;
+		int max_behind_;
+
+	public:
+		/// Create a scheduler with a given tick interval.
+		/**
+		 * The schedule is restarted when more than max_behind ticks are overdue.
+		 */
+		explicit TickScheduler(Duration interval, int max_behind = 5);
+
+		/// Start the schedule, with the first tick due one interval from now.
+		void start(Clock::time_point now = Clock::now());
+
+		/// Set the interval between ticks, taking effect from the next tick.
+		void setInterval(Duration interval) { interval_ = interval; }
+
+		/// Get the interval between ticks.
+		Duration interval() const { return interval_; }
+
+		/// Get the deadline of the next tick.
+		Clock::time_point deadline() const { return deadline_; }
+
+		/// Check if the next tick is due.
+		bool due(Clock::time_point now = Clock::now()) const { return now >= deadline_; }
+
+		/// Sleep until the next tick is due.
+		void waitForDeadline() const;
+
+		/// Mark the end of a tick and advance the deadline by one interval.
+		void endTick(Clock::time_point now = Clock::now());
+	};
+}
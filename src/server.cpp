@@ -0,0 +1,346 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "autopilot.hpp"
+#include "game.hpp"
+#include "input_queue.hpp"
+#include "net.hpp"
+#include "net_protocol.hpp"
+#include "random.hpp"
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+	/// Options of the server.
+	struct Options {
+		int port = snake::net_protocol::default_port;
+		snake::Vector2 board_size = {20, 20};
+		bool autopilot = false;
+	};
+
+	/// Clients that fall this far behind are disconnected.
+	constexpr std::size_t max_backlog = 1024 * 1024;
+
+	/// Get the time between ticks for a given score, the same as the curses game.
+	snake::TickScheduler::Duration tickInterval(int score) {
+		return std::chrono::milliseconds(10000 / (40 + score));
+	}
+
+	/// A connected client.
+	/**
+	 * Messages are sent straight from the shared broadcast buffer.
+	 * Only when the socket does not take a message completely is the rest copied into the backlog,
+	 * which is flushed when the socket becomes writable again.
+	 */
+	struct Client {
+		int fd;
+		std::vector<unsigned char> backlog;
+		std::size_t backlog_start = 0;
+		bool closed = false;
+	};
+
+	/// Serves one game to any number of clients from a single thread.
+	class Server {
+		Options options_;
+		int epoll_;
+		int listener_;
+		std::unordered_map<int, Client> clients_;
+
+		snake::DefaultGenerator generator_;
+		snake::Game game_;
+		snake::Autopilot autopilot_;
+		snake::InputQueue input_;
+		int dead_ticks_ = 0;
+
+		/// Messages for all clients, reused for every tick.
+		std::vector<unsigned char> broadcast_;
+
+		/// A snapshot for joining clients, reused for every join.
+		std::vector<unsigned char> snapshot_;
+
+		void watch(Client const & client, bool writable) {
+			epoll_event event = {};
+			event.events  = writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+			event.data.fd = client.fd;
+			epoll_ctl(epoll_, EPOLL_CTL_MOD, client.fd, &event);
+		}
+
+		/// Send data to a client, keeping whatever the socket does not take in the backlog.
+		void send(Client & client, unsigned char const * data, std::size_t size) {
+			if (client.closed) return;
+
+			// Keep the order of messages while older data is still waiting.
+			if (client.backlog_start < client.backlog.size()) {
+				if (client.backlog.size() - client.backlog_start + size > max_backlog) {
+					client.closed = true;
+					return;
+				}
+
+				// Drop the part that was already sent once it is most of the buffer,
+				// so a client that never quite catches up does not grow the buffer without bound.
+				if (client.backlog_start > client.backlog.size() / 2) {
+					client.backlog.erase(client.backlog.begin(), client.backlog.begin() + client.backlog_start);
+					client.backlog_start = 0;
+				}
+				client.backlog.insert(client.backlog.end(), data, data + size);
+				return;
+			}
+
+			ssize_t sent = ::send(client.fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (sent < 0) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+					client.closed = true;
+					return;
+				}
+				sent = 0;
+			}
+
+			if (std::size_t(sent) < size) {
+				client.backlog.assign(data + sent, data + size);
+				client.backlog_start = 0;
+				watch(client, true);
+			}
+		}
+
+		/// Flush the backlog of a writable client.
+		void flush(Client & client) {
+			while (client.backlog_start < client.backlog.size()) {
+				ssize_t sent = ::send(client.fd, client.backlog.data() + client.backlog_start, client.backlog.size() - client.backlog_start, MSG_NOSIGNAL | MSG_DONTWAIT);
+				if (sent < 0) {
+					if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+					if (errno == EINTR) continue;
+					client.closed = true;
+					return;
+				}
+				client.backlog_start += sent;
+			}
+
+			client.backlog.clear();
+			client.backlog_start = 0;
+			watch(client, false);
+		}
+
+		/// Read the actions a client sent.
+		void receive(Client & client) {
+			unsigned char buffer[256];
+			while (true) {
+				ssize_t size = ::recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+				if (size == 0) {
+					client.closed = true;
+					return;
+				}
+				if (size < 0) {
+					if (errno == EINTR) continue;
+					if (errno != EAGAIN && errno != EWOULDBLOCK) client.closed = true;
+					return;
+				}
+
+				for (ssize_t i = 0; i < size; ++i) {
+					if (buffer[i] <= snake::net_protocol::max_action) input_.push(snake::Action(buffer[i]));
+				}
+			}
+		}
+
+		void accept() {
+			while (true) {
+				int fd = ::accept(listener_, nullptr, nullptr);
+				if (fd < 0) return;
+
+				snake::setNonBlocking(fd);
+				snake::setNoDelay(fd);
+
+				epoll_event event = {};
+				event.events  = EPOLLIN;
+				event.data.fd = fd;
+				if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) != 0) {
+					::close(fd);
+					continue;
+				}
+
+				Client & client = clients_[fd];
+				client.fd = fd;
+
+				snapshot_.clear();
+				snake::appendSnapshot(snapshot_, game_);
+				send(client, snapshot_.data(), snapshot_.size());
+			}
+		}
+
+		/// Close all clients that disconnected or fell too far behind.
+		void closeClients() {
+			for (auto i = clients_.begin(); i != clients_.end();) {
+				if (!i->second.closed) {
+					++i;
+					continue;
+				}
+				::close(i->first);
+				i = clients_.erase(i);
+			}
+		}
+
+		/// Run one game tick and send its message to every client.
+		void tick() {
+			snake::Action action = input_.pop();
+			if (options_.autopilot) {
+				// The autopilot starts a new game a little while after the old one ended.
+				if (game_.alive) action = autopilot_.plan(game_);
+				else             action = ++dead_ticks_ >= 20 ? snake::Action::reset : snake::Action::none;
+			}
+			if (action == snake::Action::reset) dead_ticks_ = 0;
+
+			snake::DeltaBase before = snake::DeltaBase::of(game_);
+			game_.doTick(action, generator_);
+
+			broadcast_.clear();
+			snake::appendUpdate(broadcast_, before, game_);
+			for (auto & entry : clients_) send(entry.second, broadcast_.data(), broadcast_.size());
+		}
+
+	public:
+		explicit Server(Options const & options) : options_(options) {
+			listener_ = snake::listenTcp(options.port);
+			epoll_    = epoll_create1(0);
+			if (epoll_ < 0) throw std::runtime_error(std::string("Failed to create epoll instance: ") + std::strerror(errno));
+
+			epoll_event event = {};
+			event.events  = EPOLLIN;
+			event.data.fd = listener_;
+			epoll_ctl(epoll_, EPOLL_CTL_ADD, listener_, &event);
+
+			std::random_device rand;
+			generator_.seed(std::uint64_t(rand()) << 32 | rand());
+			game_.board_size = options.board_size;
+			game_.reset(generator_);
+		}
+
+		~Server() {
+			for (auto & entry : clients_) ::close(entry.first);
+			::close(listener_);
+			::close(epoll_);
+		}
+
+		/// Serve the game forever.
+		/**
+		 * Waits for socket events until the next tick is due, so ticks stay on schedule no matter how many clients there are.
+		 */
+		void run() {
+			snake::TickScheduler scheduler(tickInterval(game_.score));
+			std::vector<epoll_event> events(256);
+
+			while (true) {
+				auto remaining    = scheduler.deadline() - snake::TickScheduler::Clock::now();
+				auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(remaining + std::chrono::milliseconds(1) - snake::TickScheduler::Duration(1));
+				int count = epoll_wait(epoll_, events.data(), events.size(), std::max<int>(0, remaining_ms.count()));
+				if (count < 0 && errno != EINTR) throw std::runtime_error(std::string("Failed to wait for events: ") + std::strerror(errno));
+
+				for (int i = 0; i < count; ++i) {
+					int fd = events[i].data.fd;
+					if (fd == listener_) {
+						accept();
+						continue;
+					}
+
+					auto client = clients_.find(fd);
+					if (client == clients_.end()) continue;
+					if (events[i].events & (EPOLLHUP | EPOLLERR)) client->second.closed = true;
+					if (events[i].events & EPOLLIN)  receive(client->second);
+					if (events[i].events & EPOLLOUT) flush(client->second);
+				}
+
+				if (scheduler.due()) {
+					tick();
+					scheduler.setInterval(tickInterval(game_.score));
+					scheduler.endTick();
+				}
+
+				closeClients();
+			}
+		}
+	};
+
+	void printUsage(char const * name) {
+		std::cerr << "usage: " << name << " [--port N] [--width N] [--height N] [--autopilot]\n";
+	}
+
+	/// Parse the command line. Returns false if the command line is invalid.
+	bool parseOptions(int argc, char * * argv, Options & options) {
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (option == "--autopilot") {
+				options.autopilot = true;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				std::cerr << "missing value for option: " << option << "\n";
+				return false;
+			}
+			char const * value = argv[++i];
+
+			if      (option == "--port")   options.port         = std::atoi(value);
+			else if (option == "--width")  options.board_size.x = std::atoi(value);
+			else if (option == "--height") options.board_size.y = std::atoi(value);
+			else {
+				std::cerr << "unknown option: " << option << "\n";
+				return false;
+			}
+		}
+
+		if (options.board_size.x < 1 || options.board_size.y < 5) {
+			std::cerr << "the board must be at least 1x5\n";
+			return false;
+		}
+		if (options.port < 1 || options.port > 65535) {
+			std::cerr << "invalid port: " << options.port << "\n";
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char * * argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	try {
+		Server server(options);
+		std::cerr << "serving a " << options.board_size.x << "x" << options.board_size.y << " game on port " << options.port << "\n";
+		server.run();
+	} catch (std::exception const & e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+}
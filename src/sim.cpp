@@ -0,0 +1,687 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "autopilot.hpp"
+#include "fixed_game.hpp"
+#include "game.hpp"
+#include "hamiltonian.hpp"
+#include "multi_game.hpp"
+#include "pipe_policy.hpp"
+#include "random.hpp"
+#include "replay.hpp"
+#include "telemetry.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	/// The policies that can drive the simulated games.
+	/**
+	 * External programs and replays can only enter a tournament.
+	 */
+	enum class Policy {
+		random,
+		autopilot,
+		hamiltonian,
+		pipe,
+		replay,
+	};
+
+	/// A policy entered in a tournament, as given on the command line.
+	struct EntrantSpec {
+		std::string name;
+		Policy policy;
+
+		/// The command of a pipe policy or the file of a replay policy.
+		std::string argument;
+	};
+
+	/// Options for a batch of simulated games.
+	struct Options {
+		int games          = 10000;
+		int first_game     = 0;
+		int threads        = 0;
+		std::uint64_t seed = 0;
+		snake::Vector2 board_size = {20, 20};
+		int max_ticks      = 100000;
+		snake::GeneratorKind generator = snake::GeneratorKind::pcg32;
+		Policy policy = Policy::random;
+		int snakes         = 1;
+		bool fixed_engine  = true;
+		std::string telemetry_path;
+		int sample_ticks   = 1000;
+		std::vector<EntrantSpec> entrants;
+	};
+
+	/// Aggregated results of a number of games.
+	struct Results {
+		std::uint64_t games      = 0;
+		std::uint64_t snakes     = 0;
+		std::uint64_t wins       = 0;
+		std::uint64_t ticks      = 0;
+		std::uint64_t score      = 0;
+		std::uint64_t length     = 0;
+		int max_score            = 0;
+
+		Results & operator+=(Results const & other) {
+			games     += other.games;
+			snakes    += other.snakes;
+			wins      += other.wins;
+			ticks     += other.ticks;
+			score     += other.score;
+			length    += other.length;
+			max_score  = std::max(max_score, other.max_score);
+			return *this;
+		}
+
+		/// Add a finished single snake game.
+		template<typename GameType>
+		void add(GameType const & game, int game_ticks) {
+			games     += 1;
+			snakes    += 1;
+			wins      += game.won;
+			ticks     += game_ticks;
+			score     += game.score;
+			length    += game.snake.length;
+			max_score  = std::max(max_score, game.score);
+		}
+	};
+
+	/// Pick an action for a game: mostly keep going, sometimes turn at random.
+	template<typename Generator>
+	snake::Action randomPolicy(Generator & generator) {
+		static snake::Action const actions[] = {snake::Action::up, snake::Action::down, snake::Action::left, snake::Action::right};
+		std::uint32_t value = generator();
+		if (value % 8 != 0) return snake::Action::none;
+		return actions[(value >> 3) % 4];
+	}
+
+	/// Pick an action for a snake in a multi-snake game: head for the closest fruit without running into anything.
+	/**
+	 * Only looks one step ahead, so snakes do get trapped, and two snakes going for the same cell may meet head on.
+	 */
+	snake::Action greedyPolicy(snake::MultiGame const & game, int player) {
+		static snake::Direction const directions[] = {snake::Direction::up, snake::Direction::down, snake::Direction::left, snake::Direction::right};
+		snake::Player const & body = game.players[player];
+
+		snake::Vector2 target = body.head;
+		int target_distance   = -1;
+		for (snake::Vector2 const & fruit : game.fruits) {
+			int distance = std::abs(fruit.x - body.head.x) + std::abs(fruit.y - body.head.y);
+			if (target_distance < 0 || distance < target_distance) {
+				target          = fruit;
+				target_distance = distance;
+			}
+		}
+
+		snake::Action best = snake::Action::none;
+		int best_distance  = -1;
+		for (snake::Direction direction : directions) {
+			if (direction == -body.segments.front().direction) continue;
+			snake::Vector2 next = body.head + snake::directionVector(direction);
+			if (!pointInsideArea(next, game.board_size) || game.grid.snakeAt(next)) continue;
+			int distance = std::abs(target.x - next.x) + std::abs(target.y - next.y);
+			if (best_distance < 0 || distance < best_distance) {
+				best          = snake::directionAction(direction);
+				best_distance = distance;
+			}
+		}
+		return best;
+	}
+
+	/// Run the multi-snake games in the range [begin, end), with one fruit per snake.
+	template<typename Generator>
+	Results runMultiGames(Options const & options, int begin, int end) {
+		Results results;
+		snake::MultiGame game;
+		game.board_size = options.board_size;
+		Generator generator;
+		std::vector<snake::Action> actions(options.snakes);
+
+		for (int i = begin; i < end; ++i) {
+			std::uint64_t seed = snake::mixSeed(options.seed, i);
+			snake::seedGenerator(generator, seed);
+
+			game.reset(options.snakes, options.snakes, generator);
+			while (!game.finished() && game.tick < options.max_ticks) {
+				for (int p = 0; p < options.snakes; ++p) {
+					if (game.players[p].alive) actions[p] = greedyPolicy(game, p);
+				}
+				game.doTick(actions.data(), generator);
+			}
+
+			results.games  += 1;
+			results.wins   += game.aliveCount() == 1;
+			results.ticks  += game.tick;
+			for (snake::Player const & player : game.players) {
+				results.snakes    += 1;
+				results.score     += player.score;
+				results.length    += player.length;
+				results.max_score  = std::max(results.max_score, player.score);
+			}
+		}
+
+		return results;
+	}
+
+	/// Play the game with the given index with a reused game engine and a policy. Returns the number of ticks played.
+	/**
+	 * Every game is seeded from the master seed and its own index,
+	 * so results do not depend on the number of threads or on the order games are played in.
+	 *
+	 * With telemetry, the metrics of the game and the duration of every sample_ticks'th tick are recorded.
+	 * The countdown to the next sample is kept by the caller over all games of a thread,
+	 * so short games do not all sample their first tick.
+	 */
+	template<typename Generator, typename GameType, typename Plan>
+	int playGame(Options const & options, int index, GameType & game, Generator & generator, Plan & plan, int & until_sample, snake::TelemetryWriter::Producer * telemetry) {
+		snake::seedGenerator(generator, snake::mixSeed(options.seed, index));
+
+		game.reset(generator);
+		int ticks = 0;
+		while (game.alive && ticks < options.max_ticks) {
+			snake::Action action = plan(game, generator);
+			if (telemetry && options.sample_ticks > 0 && --until_sample == 0) {
+				until_sample = options.sample_ticks;
+				auto start = std::chrono::steady_clock::now();
+				game.doTick(action, generator);
+				telemetry->recordTick(snake::tickSample(index, ticks, std::chrono::steady_clock::now() - start));
+			} else {
+				game.doTick(action, generator);
+			}
+			++ticks;
+		}
+		if (telemetry) telemetry->recordGame(snake::gameMetrics(index, game, ticks));
+		return ticks;
+	}
+
+	/// Play the games in the range [begin, end) with one game engine and a policy.
+	template<typename Generator, typename GameType, typename Plan>
+	Results playGames(Options const & options, int begin, int end, GameType & game, Plan plan, snake::TelemetryWriter::Producer * telemetry) {
+		Results results;
+		Generator generator;
+		int until_sample = options.sample_ticks;
+
+		for (int i = begin; i < end; ++i) {
+			int ticks = playGame(options, i, game, generator, plan, until_sample, telemetry);
+			results.add(game, ticks);
+		}
+
+		return results;
+	}
+
+	/// Run the games in the range [begin, end) on a board of any size.
+	template<typename Generator>
+	Results runGames(Options const & options, int begin, int end, snake::TelemetryWriter::Producer * telemetry) {
+		snake::Game game;
+		game.board_size = options.board_size;
+		snake::Autopilot autopilot(options.board_size);
+		std::unique_ptr<snake::HamiltonianPlanner> hamiltonian;
+		if (options.policy == Policy::hamiltonian) hamiltonian.reset(new snake::HamiltonianPlanner(options.board_size));
+
+		return playGames<Generator>(options, begin, end, game, [&] (snake::Game const & current, Generator & generator) -> snake::Action {
+			switch (options.policy) {
+				case Policy::autopilot:   return autopilot.plan(current);
+				case Policy::hamiltonian: return hamiltonian->plan(current);
+				default:                  return randomPolicy(generator);
+			}
+		}, telemetry);
+	}
+
+	/// Run the games in the range [begin, end) with the random policy on a board with a size known at compile time.
+	template<typename Generator, int Width, int Height>
+	Results runFixedGames(Options const & options, int begin, int end, snake::TelemetryWriter::Producer * telemetry) {
+		snake::FixedGame<Width, Height> game;
+		return playGames<Generator>(options, begin, end, game, [] (snake::FixedGame<Width, Height> const &, Generator & generator) {
+			return randomPolicy(generator);
+		}, telemetry);
+	}
+
+	/// Run the single snake games in the range [begin, end).
+	/**
+	 * Common board sizes get an engine with the size fixed at compile time, unless disabled with --engine generic.
+	 * Both engines play exactly the same games, the fixed one is just faster.
+	 * The autopilot and the hamiltonian policy only plan for a snake::Game, so they always use the generic engine.
+	 */
+	template<typename Generator>
+	Results runSingleGames(Options const & options, int begin, int end, snake::TelemetryWriter::Producer * telemetry) {
+		if (options.fixed_engine && options.policy == Policy::random) {
+			snake::Vector2 size = options.board_size;
+			if (size == snake::Vector2{20, 20}) return runFixedGames<Generator, 20, 20>(options, begin, end, telemetry);
+			if (size == snake::Vector2{32, 32}) return runFixedGames<Generator, 32, 32>(options, begin, end, telemetry);
+			if (size == snake::Vector2{64, 64}) return runFixedGames<Generator, 64, 64>(options, begin, end, telemetry);
+		}
+		return runGames<Generator>(options, begin, end, telemetry);
+	}
+
+	/// A policy entered in a tournament, with everything the workers share.
+	struct Entrant {
+		EntrantSpec spec;
+
+		/// One external program per worker, since a program plays one game at a time.
+		std::vector<std::unique_ptr<snake::PipePolicy>> pipes;
+
+		/// The replay file of a replay policy.
+		std::unique_ptr<snake::ReplayFile> replay;
+
+		/// The record of every game of the tournament in the replay file, starting at the first game.
+		std::vector<snake::ReplayRecord const *> games;
+	};
+
+	/// Play tournament games on one worker until no worker has any left.
+	/**
+	 * Task t is game first_game + t / entrants.size() for entrant t % entrants.size(),
+	 * so every entrant plays the same seeds and the initial ranges of the workers mix all entrants.
+	 * The game, the planners and the replay player of the worker are reused for every game,
+	 * and results go to the worker's own results per entrant, so nothing is shared but the task ranges.
+	 *
+	 * A replay entrant re-simulates the recorded game with the index of the task,
+	 * so it plays the recorded seed instead of the seed of the tournament.
+	 * playTournament() looks up the records of the games of the tournament by their index,
+	 * and checks that they were played on the board of the tournament.
+	 */
+	template<typename Generator>
+	void runTournament(Options const & options, std::vector<Entrant> const & entrants, snake::WorkStealingRanges & tasks, int worker, std::vector<Results> & results, std::atomic<bool> const & aborted) {
+		snake::Game game;
+		game.board_size = options.board_size;
+		Generator generator;
+		snake::Autopilot autopilot(options.board_size);
+		std::unique_ptr<snake::HamiltonianPlanner> hamiltonian;
+		std::unique_ptr<snake::ReplayPlayer> replay;
+		int until_sample = 0;
+
+		for (Entrant const & entrant : entrants) {
+			if (entrant.spec.policy == Policy::hamiltonian && !hamiltonian) hamiltonian.reset(new snake::HamiltonianPlanner(options.board_size));
+		}
+
+		std::uint32_t task;
+		while (!aborted.load(std::memory_order_relaxed) && tasks.next(worker, task)) {
+			std::size_t index       = task % entrants.size();
+			int game_index          = options.first_game + task / entrants.size();
+			Entrant const & entrant = entrants[index];
+
+			if (entrant.spec.policy == Policy::replay) {
+				snake::ReplayRecord const & record = *entrant.games[game_index - options.first_game];
+				if (replay) replay->load(record);
+				else        replay.reset(new snake::ReplayPlayer(record));
+				replay->seek(record.ticks);
+				results[index].add(replay->game(), replay->tick());
+				continue;
+			}
+
+			auto plan = [&] (snake::Game const & current, Generator & generator) -> snake::Action {
+				switch (entrant.spec.policy) {
+					case Policy::autopilot:   return autopilot.plan(current);
+					case Policy::hamiltonian: return hamiltonian->plan(current);
+					case Policy::pipe:        return entrant.pipes[worker]->plan(current);
+					default:                  return randomPolicy(generator);
+				}
+			};
+			int ticks = playGame(options, game_index, game, generator, plan, until_sample, nullptr);
+			results[index].add(game, ticks);
+		}
+	}
+
+	/// Parse an integer command line argument.
+	bool parseInt(char const * value, long long & result) {
+		char * end;
+		result = std::strtoll(value, &end, 10);
+		return *value != '\0' && *end == '\0';
+	}
+
+	void printUsage(char const * name) {
+		std::cerr << "usage: " << name << " [--games N] [--first-game N] [--threads N] [--seed N] [--width N] [--height N] [--max-ticks N] [--generator pcg32|mt19937] [--policy random|autopilot|hamiltonian] [--snakes N] [--engine fixed|generic] [--telemetry FILE] [--sample-ticks N] [--entrant random|autopilot|hamiltonian|pipe:COMMAND|replay:FILE]...\n";
+	}
+
+	/// Parse the policy of a tournament entrant. Returns false if the policy is invalid.
+	bool parseEntrant(std::string const & name, EntrantSpec & entrant) {
+		entrant.name = name;
+		if      (name == "random")      entrant.policy = Policy::random;
+		else if (name == "autopilot")   entrant.policy = Policy::autopilot;
+		else if (name == "hamiltonian") entrant.policy = Policy::hamiltonian;
+		else if (name.compare(0, 5, "pipe:")   == 0 && name.size() > 5) entrant.policy = Policy::pipe;
+		else if (name.compare(0, 7, "replay:") == 0 && name.size() > 7) entrant.policy = Policy::replay;
+		else return false;
+
+		if (entrant.policy == Policy::pipe)   entrant.argument = name.substr(5);
+		if (entrant.policy == Policy::replay) entrant.argument = name.substr(7);
+		return true;
+	}
+
+	/// Parse the command line. Returns false if the command line is invalid.
+	bool parseOptions(int argc, char * * argv, Options & options) {
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (option == "--generator" && i + 1 < argc) {
+				std::string name = argv[++i];
+				if      (name == "pcg32")   options.generator = snake::GeneratorKind::pcg32;
+				else if (name == "mt19937") options.generator = snake::GeneratorKind::mt19937;
+				else {
+					std::cerr << "unknown generator: " << name << "\n";
+					return false;
+				}
+				continue;
+			}
+			if (option == "--engine" && i + 1 < argc) {
+				std::string name = argv[++i];
+				if      (name == "fixed")   options.fixed_engine = true;
+				else if (name == "generic") options.fixed_engine = false;
+				else {
+					std::cerr << "unknown engine: " << name << "\n";
+					return false;
+				}
+				continue;
+			}
+			if (option == "--entrant" && i + 1 < argc) {
+				EntrantSpec entrant;
+				if (!parseEntrant(argv[++i], entrant)) {
+					std::cerr << "unknown entrant: " << argv[i] << "\n";
+					return false;
+				}
+				options.entrants.push_back(entrant);
+				continue;
+			}
+			if (option == "--telemetry" && i + 1 < argc) {
+				options.telemetry_path = argv[++i];
+				continue;
+			}
+			if (option == "--policy" && i + 1 < argc) {
+				std::string name = argv[++i];
+				if      (name == "random")      options.policy = Policy::random;
+				else if (name == "autopilot")   options.policy = Policy::autopilot;
+				else if (name == "hamiltonian") options.policy = Policy::hamiltonian;
+				else {
+					std::cerr << "unknown policy: " << name << "\n";
+					return false;
+				}
+				continue;
+			}
+
+			long long value;
+			if (i + 1 >= argc || !parseInt(argv[i + 1], value) || value < 0) {
+				std::cerr << "invalid or missing value for option: " << option << "\n";
+				return false;
+			}
+			++i;
+			if (option != "--seed" && value > std::numeric_limits<int>::max()) {
+				std::cerr << "value out of range for option: " << option << "\n";
+				return false;
+			}
+
+			if      (option == "--games")     options.games        = value;
+			else if (option == "--first-game") options.first_game  = value;
+			else if (option == "--threads")   options.threads      = value;
+			else if (option == "--seed")      options.seed         = value;
+			else if (option == "--width")     options.board_size.x = value;
+			else if (option == "--height")    options.board_size.y = value;
+			else if (option == "--max-ticks") options.max_ticks    = value;
+			else if (option == "--snakes")    options.snakes       = value;
+			else if (option == "--sample-ticks") options.sample_ticks = value;
+			else {
+				std::cerr << "unknown option: " << option << "\n";
+				return false;
+			}
+		}
+
+		if (options.board_size.x < 1 || options.board_size.y < 5) {
+			std::cerr << "the board must be at least 1x5\n";
+			return false;
+		}
+		if (std::int64_t(options.board_size.x) * options.board_size.y > (std::int64_t(1) << 30)) {
+			std::cerr << "the board can have at most 2^30 cells\n";
+			return false;
+		}
+		if (options.snakes < 1 || options.snakes > snake::MultiGame::max_players) {
+			std::cerr << "the number of snakes must be between 1 and " << snake::MultiGame::max_players << "\n";
+			return false;
+		}
+		if (options.snakes > 1 && options.policy != Policy::random) {
+			std::cerr << "games with several snakes always use the greedy policy\n";
+			return false;
+		}
+		if (options.snakes > 1 && !options.telemetry_path.empty()) {
+			std::cerr << "telemetry is only recorded for games with a single snake\n";
+			return false;
+		}
+		bool hamiltonian = options.policy == Policy::hamiltonian;
+		for (EntrantSpec const & entrant : options.entrants) hamiltonian = hamiltonian || entrant.policy == Policy::hamiltonian;
+		if (hamiltonian && (options.board_size.x < 2 || (options.board_size.x % 2 != 0 && options.board_size.y % 2 != 0))) {
+			std::cerr << "the hamiltonian policy needs a board at least 2 wide with an even width or height\n";
+			return false;
+		}
+		if (!options.entrants.empty() && (options.snakes > 1 || !options.telemetry_path.empty())) {
+			std::cerr << "tournaments only play games with a single snake, without telemetry\n";
+			return false;
+		}
+		if (std::int64_t(options.first_game) + options.games > std::numeric_limits<int>::max()
+			|| std::uint64_t(options.games) * options.entrants.size() > std::numeric_limits<std::uint32_t>::max()) {
+			std::cerr << "too many games\n";
+			return false;
+		}
+		return true;
+	}
+
+	/// Print the first error caught by the worker threads, if any. Returns true if there was an error.
+	bool printError(std::vector<std::exception_ptr> const & errors) {
+		for (std::exception_ptr const & error : errors) {
+			if (!error) continue;
+			try {
+				std::rethrow_exception(error);
+			} catch (std::exception const & e) {
+				std::cerr << e.what() << "\n";
+			}
+			return true;
+		}
+		return false;
+	}
+
+	/// Find the record of every game of a tournament in a replay, starting at the first game. Throws std::runtime_error if a game is missing or recorded twice, or was played on another board.
+	/**
+	 * Otherwise a replay entrant would play fewer or different games than the other entrants.
+	 * Games are matched on the index stored in the records, so a file with games missing or out of order can not shift the games.
+	 */
+	std::vector<snake::ReplayRecord const *> findReplayGames(Options const & options, EntrantSpec const & spec, std::vector<snake::ReplayRecord> const & records) {
+		std::vector<snake::ReplayRecord const *> games(options.games, nullptr);
+		for (snake::ReplayRecord const & record : records) {
+			if (record.index < std::uint64_t(options.first_game) || record.index - options.first_game >= games.size()) continue;
+			snake::ReplayRecord const * & game = games[record.index - options.first_game];
+			if (game) throw std::runtime_error(spec.argument + " has game " + std::to_string(record.index) + " more than once");
+			if (record.board_size != options.board_size) {
+				throw std::runtime_error(spec.argument + ": game " + std::to_string(record.index) + " was played on another board size than the tournament");
+			}
+			game = &record;
+		}
+		for (std::size_t i = 0; i < games.size(); ++i) {
+			if (!games[i]) throw std::runtime_error(spec.argument + " has no game " + std::to_string(options.first_game + i) + ", but the tournament needs it");
+		}
+		return games;
+	}
+
+	/// Play a tournament between the entrants and print the results of every entrant.
+	/**
+	 * Games of different policies take anywhere from a few ticks to the full tick limit,
+	 * so the games are not split in fixed chunks but handed out with work stealing.
+	 */
+	int playTournament(Options const & options) {
+		std::uint32_t count = options.games * options.entrants.size();
+		int threads = options.threads;
+		if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		threads = std::max<std::int64_t>(1, std::min<std::int64_t>(threads, count));
+
+		// Start all external programs before any worker thread, so no program inherits the pipes of another.
+		std::vector<Entrant> entrants;
+		try {
+			for (EntrantSpec const & spec : options.entrants) {
+				entrants.emplace_back();
+				Entrant & entrant = entrants.back();
+				entrant.spec = spec;
+				if (spec.policy == Policy::replay) {
+					entrant.replay.reset(new snake::ReplayFile(spec.argument));
+					entrant.games = findReplayGames(options, spec, entrant.replay->records());
+				}
+				if (spec.policy == Policy::pipe) {
+					std::signal(SIGPIPE, SIG_IGN);
+					for (int t = 0; t < threads; ++t) entrant.pipes.emplace_back(new snake::PipePolicy(spec.argument));
+				}
+			}
+		} catch (std::exception const & e) {
+			std::cerr << e.what() << "\n";
+			return 1;
+		}
+
+		// Every worker has its own results per entrant and its own error, which are only read after joining.
+		snake::WorkStealingRanges tasks(count, threads);
+		std::vector<std::vector<Results>> results(threads, std::vector<Results>(entrants.size()));
+		std::vector<std::exception_ptr> errors(threads);
+		std::atomic<bool> aborted{false};
+		std::vector<std::thread> workers;
+		auto start = std::chrono::steady_clock::now();
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([&options, &entrants, &tasks, &results, &errors, &aborted, t] () {
+				try {
+					if (options.generator == snake::GeneratorKind::mt19937) {
+						runTournament<std::mt19937>(options, entrants, tasks, t, results[t], aborted);
+					} else {
+						runTournament<snake::Pcg32>(options, entrants, tasks, t, results[t], aborted);
+					}
+				} catch (...) {
+					errors[t] = std::current_exception();
+					aborted   = true;
+				}
+			});
+		}
+
+		std::vector<Results> totals(entrants.size());
+		Results total;
+		for (int t = 0; t < threads; ++t) {
+			workers[t].join();
+			for (std::size_t i = 0; i < entrants.size(); ++i) totals[i] += results[t][i];
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (printError(errors)) return 1;
+
+		std::size_t name_width = 8;
+		for (Entrant const & entrant : entrants) name_width = std::max(name_width, entrant.spec.name.size());
+
+		std::cout << std::left << std::setw(name_width) << "entrant" << std::right
+			<< std::setw(8) << "games" << std::setw(8) << "wins" << std::setw(12) << "avg score"
+			<< std::setw(10) << "max score" << std::setw(12) << "avg length" << std::setw(12) << "avg ticks" << "\n";
+		for (std::size_t i = 0; i < entrants.size(); ++i) {
+			Results const & result = totals[i];
+			double games = std::max<std::uint64_t>(result.games, 1);
+			std::cout << std::left << std::setw(name_width) << entrants[i].spec.name << std::right
+				<< std::setw(8) << result.games << std::setw(8) << result.wins << std::setw(12) << result.score / games
+				<< std::setw(10) << result.max_score << std::setw(12) << result.length / games << std::setw(12) << result.ticks / games << "\n";
+			total += result;
+		}
+		std::cout << "\n";
+		std::cout << "games:          " << total.games << "\n";
+		std::cout << "threads:        " << threads << "\n";
+		std::cout << "ticks/second:   " << total.ticks / seconds << "\n";
+		std::cout << "seconds:        " << seconds << "\n";
+		return 0;
+	}
+}
+
+int main(int argc, char * * argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (!options.entrants.empty()) return playTournament(options);
+
+	int threads = options.threads;
+	if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max(1, std::min(threads, options.games));
+
+	// Every thread records its telemetry through its own queues.
+	std::unique_ptr<snake::TelemetryWriter> telemetry;
+	if (!options.telemetry_path.empty()) {
+		try {
+			telemetry.reset(new snake::TelemetryWriter(options.telemetry_path, threads));
+		} catch (std::exception const & e) {
+			std::cerr << e.what() << "\n";
+			return 1;
+		}
+	}
+
+	// Give every thread a contiguous chunk of games, its own results and its own error.
+	std::vector<Results> results(threads);
+	std::vector<std::exception_ptr> errors(threads);
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (int t = 0; t < threads; ++t) {
+		int begin = options.first_game + std::int64_t(options.games) * t       / threads;
+		int end   = options.first_game + std::int64_t(options.games) * (t + 1) / threads;
+		workers.emplace_back([&options, &results, &errors, &telemetry, t, begin, end] () {
+			bool multi = options.snakes > 1;
+			snake::TelemetryWriter::Producer * producer = telemetry ? &telemetry->producer(t) : nullptr;
+			try {
+				if (options.generator == snake::GeneratorKind::mt19937) {
+					results[t] = multi ? runMultiGames<std::mt19937>(options, begin, end) : runSingleGames<std::mt19937>(options, begin, end, producer);
+				} else {
+					results[t] = multi ? runMultiGames<snake::Pcg32>(options, begin, end) : runSingleGames<snake::Pcg32>(options, begin, end, producer);
+				}
+			} catch (...) {
+				errors[t] = std::current_exception();
+			}
+		});
+	}
+
+	Results total;
+	for (int t = 0; t < threads; ++t) {
+		workers[t].join();
+		total += results[t];
+	}
+	// Stop the clock before the telemetry writer flushes, so file I/O does not count against the simulation.
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	telemetry.reset();
+	if (printError(errors)) return 1;
+
+	// Scores and lengths are averaged per snake, ticks per game.
+	// A multi-snake game counts as a win when a single snake survived.
+	double games  = std::max<std::uint64_t>(total.games, 1);
+	double snakes = std::max<std::uint64_t>(total.snakes, 1);
+	std::cout << "games:          " << total.games << "\n";
+	std::cout << "threads:        " << threads << "\n";
+	std::cout << "wins:           " << total.wins << "\n";
+	std::cout << "average score:  " << total.score  / snakes << "\n";
+	std::cout << "max score:      " << total.max_score << "\n";
+	std::cout << "average length: " << total.length / snakes << "\n";
+	std::cout << "average ticks:  " << total.ticks  / games << "\n";
+	std::cout << "ticks/second:   " << total.ticks  / seconds << "\n";
+	std::cout << "seconds:        " << seconds << "\n";
+}
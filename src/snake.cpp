@@ -0,0 +1,37 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "snake.hpp"
+
+namespace snake {
+	bool pointCollidesWithSnake(Vector2 const & point, SnakeBody const & snake, bool check_head) {
+		Vector2 start = snake.head;
+		for (unsigned int i = 0; i < snake.segments.size(); ++i) {
+			Segment const & segment = snake.segments[i];
+			if ((check_head || i > 0) && pointOnLine(point, Line{start, -segment.direction, segment.length})) {
+				return true;
+			}
+			start = start - (directionVector(segment.direction) * segment.length);
+		}
+		return false;
+	}
+
+	bool snakeCollided(Snake const & snake, Vector2 const & field_size) {
+		return !pointInsideArea(snake.head, field_size) || snake.occupancy.count(snake.head) > 1;
+	}
+}
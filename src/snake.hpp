@@ -0,0 +1,294 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "geometry.hpp"
+#include "ring_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace snake {
+	/// Storage for a board with a size chosen at run time, with the grids on the heap.
+	/**
+	 * This is one of the storage policies of BasicOccupancy, BasicSnake and BasicGame, the other is FixedStorage.
+	 * A policy gives the type of the board size, the type of cell indices,
+	 * a Grid with one element per cell, a List of up to one element per cell, and functions to resize them.
+	 */
+	struct DynamicStorage {
+		using Size  = Vector2;
+		using Index = int;
+
+		template<typename T> using Grid = std::vector<T>;
+		template<typename T> using List = std::vector<T>;
+
+		static void setSize(Size & size, Vector2 const & new_size) { size = new_size; }
+
+		template<typename T>
+		static void resizeGrid(Grid<T> & grid, std::size_t cells) { grid.resize(cells); }
+	};
+
+	/// Per-cell occupancy counters for a board.
+	/**
+	 * A cell can briefly be occupied twice when the head moves onto the body,
+	 * so the grid keeps a counter per cell rather than a single bit.
+	 * Points outside of the board are ignored.
+	 *
+	 * Next to the counters, the grid keeps an indexable set of free cells.
+	 * Cells are swap-removed from the set when they become occupied,
+	 * so picking a random free cell is a single lookup.
+	 * The order of the set only depends on the moves, so every storage policy picks the same free cells.
+	 */
+	template<typename Storage>
+	class BasicOccupancy {
+		using Index = typename Storage::Index;
+
+		typename Storage::Size size_ = {};
+		typename Storage::template Grid<unsigned char> cells_;
+
+		/// The indices of all free cells, in no particular order.
+		typename Storage::template List<Index> free_;
+
+		/// The position of each free cell in free_. Entries of occupied cells are meaningless.
+		typename Storage::template Grid<Index> free_position_;
+
+		int width() const { return Vector2(size_).x; }
+		int index(Vector2 const & point) const { return point.y * width() + point.x; }
+
+		void removeFree(int cell) {
+			int position = free_position_[cell];
+			int last     = free_.back();
+			free_[position]       = last;
+			free_position_[last]  = position;
+			free_.pop_back();
+		}
+
+		void addFree(int cell) {
+			free_position_[cell] = free_.size();
+			free_.push_back(cell);
+		}
+
+	public:
+		/// Get the size of the board, which converts to a Vector2.
+		typename Storage::Size const & size() const { return size_; }
+
+		/// Resize the board and mark all cells as free.
+		void reset(Vector2 const & size) {
+			Storage::setSize(size_, size);
+			Storage::resizeGrid(cells_, std::size_t(size.x) * size.y);
+			Storage::resizeGrid(free_position_, cells_.size());
+			std::fill(cells_.begin(), cells_.end(), 0);
+			free_.resize(cells_.size());
+			for (std::size_t i = 0; i < cells_.size(); ++i) {
+				free_[i]          = i;
+				free_position_[i] = i;
+			}
+		}
+
+		/// Get the number of times a point is occupied.
+		int count(Vector2 const & point) const {
+			if (!pointInsideArea(point, size())) return 0;
+			return cells_[index(point)];
+		}
+
+		/// Check if a point is occupied.
+		bool occupied(Vector2 const & point) const { return count(point) > 0; }
+
+		/// Mark a point as occupied once more.
+		void add(Vector2 const & point) {
+			if (!pointInsideArea(point, size())) return;
+			int cell = index(point);
+			if (cells_[cell]++ == 0) removeFree(cell);
+		}
+
+		/// Mark a point as occupied once less.
+		void remove(Vector2 const & point) {
+			if (!pointInsideArea(point, size())) return;
+			int cell = index(point);
+			if (--cells_[cell] == 0) addFree(cell);
+		}
+
+		/// Get the number of free cells.
+		int freeCount() const { return free_.size(); }
+
+		/// Get a free cell by index in the range [0, freeCount()).
+		Vector2 freeCell(int i) const { return {free_[i] % width(), free_[i] / width()}; }
+
+		/// Get the cell index (y * width + x) of a free cell by index in the range [0, freeCount()).
+		int freeIndex(int i) const { return free_[i]; }
+
+		/// Start rebuilding the grid of a saved game, with all cells free and the set of free cells empty.
+		/**
+		 * The order of the free set depends on the whole history of the grid,
+		 * so it has to be restored to get the same random free cells as the original.
+		 * Mark the occupied cells with addRestored() and set the order of the free set with finishRestore().
+		 * Apart from filling the grid, restoring touches every cell of the snake and of the free set once.
+		 * Free positions of -1 mark cells that are not in the free set yet, so this needs a signed Index.
+		 */
+		void beginRestore(Vector2 const & size) {
+			static_assert(std::is_signed<Index>::value, "restoring needs a signed cell index");
+			Storage::setSize(size_, size);
+			Storage::resizeGrid(cells_, std::size_t(size.x) * size.y);
+			Storage::resizeGrid(free_position_, cells_.size());
+			std::fill(cells_.begin(), cells_.end(), 0);
+			std::fill(free_position_.begin(), free_position_.end(), -1);
+			free_.clear();
+		}
+
+		/// Mark a free point as occupied while restoring.
+		/**
+		 * Returns false if the point is outside the board or already occupied,
+		 * since the snake of a valid game never overlaps itself.
+		 */
+		bool addRestored(Vector2 const & point) {
+			if (!pointInsideArea(point, size())) return false;
+			unsigned char & cell = cells_[index(point)];
+			if (cell != 0) return false;
+			cell = 1;
+			return true;
+		}
+
+		/// Set the order of the free set, where order(i) gives the cell index (y * width + x) at position i.
+		/**
+		 * Returns false, leaving the grid invalid, if a listed cell is occupied or listed twice.
+		 * A free count that adds up with the occupied cells to the whole board then means every free cell is listed.
+		 */
+		template<typename Order>
+		bool finishRestore(std::size_t free_count, Order order) {
+			if (free_count > cells_.size()) return false;
+			free_.resize(free_count);
+			for (std::size_t i = 0; i < free_count; ++i) {
+				std::int64_t cell = order(i);
+				if (cell < 0 || std::size_t(cell) >= cells_.size() || cells_[cell] != 0 || free_position_[cell] != -1) return false;
+				free_[i]             = cell;
+				free_position_[cell] = i;
+			}
+			return true;
+		}
+	};
+
+	/// Per-cell occupancy counters for a board with a size chosen at run time.
+	using Occupancy = BasicOccupancy<DynamicStorage>;
+
+	/// The body of a snake as a list of segments from the head to the tail, without any board state.
+	struct SnakeBody {
+		Vector2 head;
+		Vector2 tail;
+		int length = 0;
+		RingBuffer<Segment> segments;
+
+		/// Reset the body to a single straight segment.
+		/**
+		 * The segment extends from the head in the opposite direction of the segment.
+		 * The capacity of the segment buffer is kept, so resetting does not allocate.
+		 */
+		void reset(Vector2 const & head, Segment const & segment) {
+			this->head   = head;
+			this->tail   = head - directionVector(segment.direction) * (segment.length - 1);
+			this->length = segment.length;
+			segments.clear();
+			segments.push_back(segment);
+		}
+
+		/// Move the head forward in a given direction.
+		void moveHead(Direction const & direction) {
+			// If the snake changed direction, insert a new segment at the front.
+			if (segments.front().direction != direction) {
+				segments.push_front({direction, 0});
+			}
+
+			// Move the head and lengthen the first segment.
+			head += directionVector(segments.front().direction);
+			segments.front().length += 1;
+			length += 1;
+		}
+
+		/// Shrink the tail by one cell.
+		/**
+		 * The exhausted final segment has to be dropped before the tail moves,
+		 * because the new tail then lies on the segment before it.
+		 */
+		void shrinkTail() {
+			segments.back().length  -= 1;
+			length -= 1;
+
+			// If the final segment reaches length zero, delete it.
+			if (segments.back().length <= 0) {
+				segments.pop_back();
+			}
+
+			// The new tail is the next point towards the head on the final segment.
+			tail += directionVector(segments.back().direction);
+		}
+	};
+
+	/// A snake with its own occupancy grid.
+	template<typename Storage>
+	struct BasicSnake : SnakeBody {
+		BasicOccupancy<Storage> occupancy;
+
+		/// Reset the snake to a single straight segment on a board of the given size.
+		/**
+		 * The segment extends from the head in the opposite direction of the segment.
+		 * The capacity of the segment buffer and the occupancy grid is kept, so resetting does not allocate.
+		 */
+		void reset(Vector2 const & board_size, Vector2 const & head, Segment const & segment) {
+			SnakeBody::reset(head, segment);
+			occupancy.reset(board_size);
+
+			Vector2 point = head;
+			for (int i = 0; i < segment.length; ++i) {
+				occupancy.add(point);
+				point -= directionVector(segment.direction);
+			}
+		}
+
+		/// Move the snake head forward in a given direction.
+		void moveHead(Direction const & direction) {
+			SnakeBody::moveHead(direction);
+			occupancy.add(head);
+		}
+
+		/// Shrink the tail of the snake.
+		void shrinkTail() {
+			occupancy.remove(tail);
+			SnakeBody::shrinkTail();
+		}
+	};
+
+	/// A snake on a board with a size chosen at run time.
+	using Snake = BasicSnake<DynamicStorage>;
+
+	/// Check for a collision of a point with a snake.
+	/**
+	 * This walks all segments of the snake.
+	 * It is the reference implementation for the occupancy grids.
+	 */
+	bool pointCollidesWithSnake(Vector2 const & point, SnakeBody const & snake, bool check_head = true);
+
+	/// Check if the snake has in internal or external collision.
+	/**
+	 * Uses the occupancy grid of the snake, so this runs in constant time.
+	 * The head occupies its own cell once, so any higher count means the head hit the body.
+	 */
+	bool snakeCollided(Snake const & snake, Vector2 const & field_size);
+}
@@ -0,0 +1,73 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace snake {
+	/// Bounded lock-free queue for one producer thread and one consumer thread.
+	/**
+	 * The capacity is a compile time power of two, so the queue never allocates.
+	 * Both indices only ever increase and wrap with a mask,
+	 * and each lives on its own cache line so the two threads do not contend.
+	 */
+	template<typename T, std::size_t Capacity>
+	class SpscQueue {
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+		static constexpr std::size_t mask = Capacity - 1;
+
+		std::array<T, Capacity> data_;
+		alignas(64) std::atomic<std::size_t> head_{0};
+		alignas(64) std::atomic<std::size_t> tail_{0};
+
+	public:
+		static constexpr std::size_t capacity = Capacity;
+
+		/// Add an element to the queue. Returns false if the queue is full.
+		/**
+		 * May only be called from the producer thread.
+		 */
+		bool push(T const & value) {
+			std::size_t tail = tail_.load(std::memory_order_relaxed);
+			if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+			data_[tail & mask] = value;
+			tail_.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Take the oldest element from the queue. Returns false if the queue is empty.
+		/**
+		 * May only be called from the consumer thread.
+		 */
+		bool pop(T & value) {
+			std::size_t head = head_.load(std::memory_order_relaxed);
+			if (head == tail_.load(std::memory_order_acquire)) return false;
+			value = data_[head & mask];
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Check if the queue is empty. The answer may be out of date by the time it is used.
+		bool empty() const {
+			return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+		}
+	};
+}
@@ -0,0 +1,141 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "telemetry.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace snake {
+	namespace {
+		/// Write a little endian integer of a number of bytes. Returns the position after it.
+		unsigned char * putInteger(unsigned char * out, std::uint64_t value, int bytes) {
+			for (int i = 0; i < bytes; ++i) out[i] = value >> (8 * i);
+			return out + bytes;
+		}
+
+		/// Append a block header to a buffer, and make room for rows of a number of bytes.
+		/**
+		 * Returns the start of the room for the columns.
+		 */
+		unsigned char * beginBlock(std::vector<unsigned char> & out, unsigned char kind, std::size_t rows, std::size_t row_size) {
+			std::size_t start = out.size();
+			out.resize(start + 5 + rows * row_size);
+			out[start] = kind;
+			return putInteger(&out[start + 1], rows, 4);
+		}
+	}
+
+	TelemetryWriter::TelemetryWriter(std::string const & path, int producers) {
+		// Writes always go to the end of the file, but the header of an existing file is read back first.
+		file_ = std::fopen(path.c_str(), "a+b");
+		if (!file_) throw std::runtime_error("Failed to open telemetry file for writing: " + path);
+
+		// Only write a header to new files, so telemetry of several runs can go to one file.
+		// Readers can not skip blocks they do not know, so existing files must have the current version.
+		std::fseek(file_, 0, SEEK_END);
+		if (std::ftell(file_) == 0) {
+			buffer_.insert(buffer_.end(), telemetry_format::magic, telemetry_format::magic + 4);
+			buffer_.push_back(telemetry_format::version);
+		} else {
+			unsigned char header[telemetry_format::header_size];
+			std::rewind(file_);
+			bool valid = std::fread(header, 1, sizeof(header), file_) == sizeof(header) && std::memcmp(header, telemetry_format::magic, 4) == 0;
+			if (!valid || header[4] != telemetry_format::version) {
+				std::fclose(file_);
+				if (!valid) throw std::runtime_error("Can not append to a file that is not a telemetry file: " + path);
+				throw std::runtime_error("Can not append to a telemetry file with a different version: " + path);
+			}
+		}
+
+		for (int i = 0; i < producers; ++i) producers_.push_back(makeAligned<Producer>());
+		games_.reserve(block_rows);
+		ticks_.reserve(block_rows);
+		thread_ = std::thread([this] () { run(); });
+	}
+
+	TelemetryWriter::~TelemetryWriter() {
+		stop_ = true;
+		thread_.join();
+		std::fclose(file_);
+	}
+
+	bool TelemetryWriter::drain() {
+		bool any = false;
+		for (auto & producer : producers_) {
+			GameMetrics metrics;
+			while (producer->games_.pop(metrics)) {
+				games_.push_back(metrics);
+				if (games_.size() == block_rows) writeGames();
+				any = true;
+			}
+
+			TickSample sample;
+			while (producer->ticks_.pop(sample)) {
+				ticks_.push_back(sample);
+				if (ticks_.size() == block_rows) writeTicks();
+				any = true;
+			}
+		}
+		return any;
+	}
+
+	void TelemetryWriter::writeGames() {
+		if (games_.empty()) return;
+		unsigned char * out = beginBlock(buffer_, telemetry_format::games_block, games_.size(), 8 + 3 * 4 + 2);
+		for (GameMetrics const & row : games_) out = putInteger(out, row.game, 8);
+		for (GameMetrics const & row : games_) out = putInteger(out, row.score, 4);
+		for (GameMetrics const & row : games_) out = putInteger(out, row.length, 4);
+		for (GameMetrics const & row : games_) out = putInteger(out, row.ticks, 4);
+		for (GameMetrics const & row : games_) *out++ = static_cast<unsigned char>(row.death_cause);
+		for (GameMetrics const & row : games_) *out++ = row.won;
+		games_.clear();
+
+		std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+		buffer_.clear();
+	}
+
+	void TelemetryWriter::writeTicks() {
+		if (ticks_.empty()) return;
+		unsigned char * out = beginBlock(buffer_, telemetry_format::ticks_block, ticks_.size(), 8 + 2 * 4);
+		for (TickSample const & row : ticks_) out = putInteger(out, row.game, 8);
+		for (TickSample const & row : ticks_) out = putInteger(out, row.tick, 4);
+		for (TickSample const & row : ticks_) out = putInteger(out, row.nanoseconds, 4);
+		ticks_.clear();
+
+		std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+		buffer_.clear();
+	}
+
+	void TelemetryWriter::run() {
+		// Poll the queues, and sleep a little whenever they are all empty.
+		// Once told to stop, the producers are done, so one more drain gets everything.
+		while (!stop_.load(std::memory_order_acquire)) {
+			if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		drain();
+		writeGames();
+		writeTicks();
+
+		// Write the header of a new file even if nothing was recorded.
+		if (!buffer_.empty()) std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+		buffer_.clear();
+		std::fflush(file_);
+	}
+}
@@ -0,0 +1,164 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "aligned.hpp"
+#include "game.hpp"
+#include "spsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace snake {
+	/// Telemetry is stored as a stream of columnar blocks.
+	/**
+	 * A telemetry file starts with the magic bytes "NSTM" and a version byte,
+	 * followed by any number of blocks. All integers are little endian. Each block is:
+	 *  - one byte with the kind of the block,
+	 *  - the number of rows as a 32 bit integer,
+	 *  - every column of the block in turn, with one value per row.
+	 *
+	 * Game blocks have the columns:
+	 *  - the index of the game as a 64 bit integer,
+	 *  - the score, the final length of the snake and the number of ticks as 32 bit integers,
+	 *  - the DeathCause as one byte,
+	 *  - one byte that is 1 if the game was won and 0 otherwise.
+	 *
+	 * Tick blocks hold sampled tick durations, with the columns:
+	 *  - the index of the game as a 64 bit integer,
+	 *  - the tick in the game as a 32 bit integer,
+	 *  - the duration of the tick in nanoseconds as a 32 bit integer.
+	 *
+	 * Rows are in the order they were received by the writer, not necessarily in the order of the game index.
+	 * Unknown block kinds can not be skipped, so new columns need a new version.
+	 */
+	namespace telemetry_format {
+		constexpr char magic[4] = {'N', 'S', 'T', 'M'};
+		constexpr unsigned char version = 1;
+		constexpr std::size_t header_size = 5;
+
+		constexpr unsigned char games_block = 1;
+		constexpr unsigned char ticks_block = 2;
+	}
+
+	/// The metrics of a finished game.
+	struct GameMetrics {
+		std::uint64_t game;
+		std::uint32_t score;
+		std::uint32_t length;
+		std::uint32_t ticks;
+		DeathCause death_cause;
+		bool won;
+	};
+
+	/// The duration of a single tick.
+	struct TickSample {
+		std::uint64_t game;
+		std::uint32_t tick;
+		std::uint32_t nanoseconds;
+	};
+
+	/// Get the sample of a tick that took a duration, saturating durations that do not fit the 32 bit column (about 4.3 seconds).
+	template<typename Rep, typename Period>
+	TickSample tickSample(std::uint64_t game, std::uint32_t tick, std::chrono::duration<Rep, Period> const & duration) {
+		auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+		if (nanoseconds < 0) nanoseconds = 0;
+		if (nanoseconds > std::numeric_limits<std::uint32_t>::max()) nanoseconds = std::numeric_limits<std::uint32_t>::max();
+		return {game, tick, std::uint32_t(nanoseconds)};
+	}
+
+	/// Get the metrics of a game that ended or was cut off after a number of ticks.
+	template<typename GameType>
+	GameMetrics gameMetrics(std::uint64_t index, GameType const & game, std::uint32_t ticks) {
+		return {index, std::uint32_t(game.score), std::uint32_t(game.snake.length), ticks, game.death_cause, game.won};
+	}
+
+	/// Streams telemetry to a file from a background thread.
+	/**
+	 * Every thread that records telemetry gets its own Producer with bounded lock-free queues,
+	 * so recording is a copy into a ring buffer. The background thread drains all queues,
+	 * collects the rows in columns and appends whole blocks to the file.
+	 *
+	 * When a queue is full, recording waits for the writer rather than losing data.
+	 */
+	class TelemetryWriter {
+	public:
+		static constexpr std::size_t queue_size = 4096;
+		static constexpr std::size_t block_rows = 4096;
+
+		/// The queues of one recording thread.
+		class Producer {
+			friend class TelemetryWriter;
+			SpscQueue<GameMetrics, queue_size> games_;
+			SpscQueue<TickSample, queue_size> ticks_;
+
+		public:
+			/// Record the metrics of a game. May only be called from one thread at a time.
+			void recordGame(GameMetrics const & metrics) {
+				while (!games_.push(metrics)) std::this_thread::yield();
+			}
+
+			/// Record the duration of a tick. May only be called from one thread at a time.
+			void recordTick(TickSample const & sample) {
+				while (!ticks_.push(sample)) std::this_thread::yield();
+			}
+		};
+
+		/// Open a telemetry file for appending and start the writer thread.
+		/**
+		 * Throws std::runtime_error if the file can not be opened or is not a telemetry file of the current version.
+		 */
+		explicit TelemetryWriter(std::string const & path, int producers = 1);
+		TelemetryWriter(TelemetryWriter const &) = delete;
+		TelemetryWriter & operator=(TelemetryWriter const &) = delete;
+
+		/// Write everything recorded so far and close the file.
+		/**
+		 * All producers must be done recording.
+		 */
+		~TelemetryWriter();
+
+		/// Get the queues for a recording thread, in the range [0, producers).
+		Producer & producer(int index) { return *producers_[index]; }
+
+	private:
+		std::FILE * file_ = nullptr;
+		std::vector<AlignedPtr<Producer>> producers_;
+		std::vector<GameMetrics> games_;
+		std::vector<TickSample> ticks_;
+		std::vector<unsigned char> buffer_;
+		std::atomic<bool> stop_{false};
+		std::thread thread_;
+
+		/// Move everything from the queues into the pending rows. Returns false if there was nothing.
+		bool drain();
+
+		void writeGames();
+		void writeTicks();
+		void run();
+	};
+}
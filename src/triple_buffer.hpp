@@ -0,0 +1,76 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace snake {
+	/// Lock-free triple buffer to pass the latest value from one producer thread to one consumer thread.
+	/**
+	 * The producer fills the back buffer and publishes it, the consumer picks up the most recently published buffer.
+	 * Neither side ever waits for the other: values published faster than they are consumed are simply overwritten,
+	 * so a slow consumer always sees the newest value and a slow producer never stalls the consumer.
+	 *
+	 * The three buffers are constructed up front and reused, so nothing is allocated while passing values.
+	 */
+	template<typename T>
+	class TripleBuffer {
+		static constexpr unsigned index_mask = 0x3;
+		static constexpr unsigned fresh_bit  = 0x4;
+
+		std::array<T, 3> buffers_;
+
+		/// Index of the buffer shared between producer and consumer, with fresh_bit set if it was not consumed yet.
+		std::atomic<unsigned> middle_{0};
+
+		unsigned back_  = 1;
+		unsigned front_ = 2;
+
+	public:
+		TripleBuffer() = default;
+
+		/// Create a triple buffer with all three buffers copied from an initial value.
+		explicit TripleBuffer(T const & initial) : buffers_{{initial, initial, initial}} {}
+
+		/// Get the buffer the producer is filling.
+		T & back() { return buffers_[back_]; }
+
+		/// Publish the back buffer to the consumer and continue with another buffer.
+		/**
+		 * The new back buffer holds an older value, so the producer should overwrite it entirely.
+		 */
+		void publish() {
+			back_ = middle_.exchange(back_ | fresh_bit, std::memory_order_acq_rel) & index_mask;
+		}
+
+		/// Pick up the most recently published buffer, if there is a new one.
+		/**
+		 * Returns false if nothing was published since the last update, in which case front() is unchanged.
+		 */
+		bool update() {
+			if (!(middle_.load(std::memory_order_relaxed) & fresh_bit)) return false;
+			front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+			return true;
+		}
+
+		/// Get the buffer the consumer picked up with the last update.
+		T const & front() const { return buffers_[front_]; }
+	};
+}
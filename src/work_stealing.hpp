@@ -0,0 +1,98 @@
+/*
+ *  nsnake: ncurses snake
+ *  Copyright (C) 2016 - Maarten de Vries <maarten@de-vri.es>
+
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "aligned.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace snake {
+	/// Lock-free distribution of a fixed number of tasks over worker threads, with work stealing.
+	/**
+	 * Tasks are the indices [0, count). Every worker starts with an equal, contiguous range of them
+	 * and takes tasks from the front of its own range. A worker that runs out steals the back half
+	 * of the range of another worker, so a few long tasks do not leave the other workers idle.
+	 *
+	 * Each range is a pair of 32 bit indices packed in one atomic, on its own cache line,
+	 * so taking and stealing are single compare-and-swap operations.
+	 * A range only ever shrinks or is replaced by a stolen range of tasks nobody took yet,
+	 * so a compare-and-swap can not succeed on a stale value.
+	 */
+	class WorkStealingRanges {
+		struct alignas(64) Range {
+			std::atomic<std::uint64_t> bounds{0};
+		};
+
+		int workers_;
+		AlignedArray<Range> ranges_;
+
+		static std::uint64_t pack(std::uint32_t begin, std::uint32_t end) { return std::uint64_t(begin) << 32 | end; }
+		static std::uint32_t begin(std::uint64_t bounds) { return bounds >> 32; }
+		static std::uint32_t end(std::uint64_t bounds) { return bounds & 0xffffffff; }
+
+		/// Take the first task of a range. Returns false if the range is empty.
+		bool take(Range & range, std::uint32_t & task) {
+			std::uint64_t bounds = range.bounds.load(std::memory_order_acquire);
+			while (begin(bounds) < end(bounds)) {
+				if (range.bounds.compare_exchange_weak(bounds, pack(begin(bounds) + 1, end(bounds)), std::memory_order_acq_rel)) {
+					task = begin(bounds);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// Steal the back half of the range of a victim into an empty range. Returns false if the victim has nothing left.
+		bool steal(Range & victim, Range & thief) {
+			std::uint64_t bounds = victim.bounds.load(std::memory_order_acquire);
+			while (begin(bounds) < end(bounds)) {
+				std::uint32_t half  = (end(bounds) - begin(bounds) + 1) / 2;
+				std::uint32_t split = end(bounds) - half;
+				if (victim.bounds.compare_exchange_weak(bounds, pack(begin(bounds), split), std::memory_order_acq_rel)) {
+					thief.bounds.store(pack(split, end(bounds)), std::memory_order_release);
+					return true;
+				}
+			}
+			return false;
+		}
+
+	public:
+		/// Split count tasks over a number of workers.
+		WorkStealingRanges(std::uint32_t count, int workers) : workers_(workers), ranges_(makeAlignedArray<Range>(workers)) {
+			for (int i = 0; i < workers; ++i) {
+				ranges_[i].bounds.store(pack(std::uint64_t(count) * i / workers, std::uint64_t(count) * (i + 1) / workers));
+			}
+		}
+
+		/// Get the next task for a worker, stealing from the other workers if needed.
+		/**
+		 * Returns false once no worker has tasks left.
+		 * Tasks that were stolen but not yet published by the thief are not waited for, since the thief runs them.
+		 */
+		bool next(int worker, std::uint32_t & task) {
+			Range & own = ranges_[worker];
+			if (take(own, task)) return true;
+			for (int i = 1; i < workers_; ++i) {
+				if (steal(ranges_[(worker + i) % workers_], own) && take(own, task)) return true;
+			}
+			return false;
+		}
+	};
+}